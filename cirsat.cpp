@@ -24,17 +24,36 @@
  */
 
 #include "aig.hpp"
+#include "aig_dpll_solver.hpp"
+#include "cube_and_conquer.hpp"
 #include "mffc_view.hpp"
+#include "output_solver.hpp"
+#include "sat_sweeper.hpp"
 #include "solver.hpp"
 
 #include <algorithm>
+#include <chrono>
 #include <fstream>
 #include <iostream>
 #include <limits>
 #include <sstream>
 #include <string>
+#include <thread>
 #include <unordered_map>
 
+static const char* statusName( cirsat::sat_status status )
+{
+    switch ( status )
+    {
+    case cirsat::sat_status::sat:
+        return "SAT";
+    case cirsat::sat_status::unsat:
+        return "UNSAT";
+    default:
+        return "UNKNOWN";
+    }
+}
+
 static void printUsage()
 {
     std::cout << "Usage: cirsat [command] [options]\n"
@@ -43,7 +62,28 @@ static void printUsage()
               << "\nOptions:\n"
               << "  -h, --help             Show this help message\n"
               << "  -v, --version          Show version information\n"
-              << "  --limit <N>            Max nodes traversed when collecting an MFFC (default 100)\n";
+              << "  --limit <N>            Max nodes traversed when collecting an MFFC (default 100)\n"
+              << "  --decision <name>      Decision heuristic: jfrontier (default) or vsids\n"
+              << "  --restart <name>       Restart policy: none, luby, geometric or glucose (default)\n"
+              << "  --phase <name>         Decision phase: fixed, saved (default) or target\n"
+              << "  --sim-phase            Take initial phases from random simulation\n"
+              << "  --conflicts <N>        Give up after N conflicts and answer UNKNOWN (default 0, unlimited)\n"
+              << "  --sim-rounds <N>       Blocks of 256 random patterns tried once before any solver starts\n"
+              << "                         (default 16, 0 disables)\n"
+              << "  --strash               Merge trivial and identical AND gates while reading, renumbering\n"
+              << "                         the nodes of cube files (default)\n"
+              << "  --no-strash            Keep the AND gates and node numbers of the file as they are\n"
+              << "  --sweep                Merge equivalent nodes by SAT sweeping before solving\n"
+              << "  --per-output           Solve each output separately on its cone of influence, on --threads\n"
+              << "                         workers, and print one result per output\n"
+              << "  --threads <N>          Race N differently configured solvers, 0 uses every core (default 1)\n"
+              << "  --no-share             Do not exchange learned gates between the racing solvers\n"
+              << "  --cubes <N>            Cube-and-conquer: split into about N cubes by lookahead and solve\n"
+              << "                         them on --threads workers\n"
+              << "  --dump-cubes <file>    Write the cubes of the lookahead to file instead of solving them\n"
+              << "  --cube-file <file>     Solve only the cubes listed in file, the circuit must be loaded\n"
+              << "                         with the options used to dump them; without a SAT cube the\n"
+              << "                         answer only covers those cubes\n";
 }
 
 int main( int argc, char* argv[] )
@@ -79,7 +119,15 @@ int main( int argc, char* argv[] )
         }
 
         bool verbose = false;
+        bool strash = true;
+        bool sweep = false;
+        bool per_output = false;
         uint32_t limit = 100u;
+        uint32_t threads = 1u;
+        bool cube_mode = false;
+        cirsat::cube_params cps;
+        std::string dump_cubes, cube_file;
+        cirsat::aig_dpll_params ps;
         for ( int i = 3; i < argc; i++ )
         {
             std::string option = argv[i];
@@ -91,6 +139,124 @@ int main( int argc, char* argv[] )
             {
                 limit = static_cast<uint32_t>( std::stoul( argv[++i] ) );
             }
+            else if ( option == "--decision" && i + 1 < argc )
+            {
+                std::string name = argv[++i];
+                if ( name == "vsids" )
+                {
+                    ps.decision = cirsat::decision_strategy::vsids;
+                }
+                else if ( name == "jfrontier" )
+                {
+                    ps.decision = cirsat::decision_strategy::jfrontier_fanout;
+                }
+                else
+                {
+                    std::cout << "Error: Unknown decision heuristic " << name << std::endl;
+                    return 1;
+                }
+            }
+            else if ( option == "--restart" && i + 1 < argc )
+            {
+                std::string name = argv[++i];
+                if ( name == "none" )
+                {
+                    ps.restart = cirsat::restart_policy::none;
+                }
+                else if ( name == "luby" )
+                {
+                    ps.restart = cirsat::restart_policy::luby;
+                }
+                else if ( name == "geometric" )
+                {
+                    ps.restart = cirsat::restart_policy::geometric;
+                }
+                else if ( name == "glucose" )
+                {
+                    ps.restart = cirsat::restart_policy::glucose;
+                }
+                else
+                {
+                    std::cout << "Error: Unknown restart policy " << name << std::endl;
+                    return 1;
+                }
+            }
+            else if ( option == "--phase" && i + 1 < argc )
+            {
+                std::string name = argv[++i];
+                if ( name == "fixed" )
+                {
+                    ps.phase = cirsat::phase_policy::fixed;
+                }
+                else if ( name == "saved" )
+                {
+                    ps.phase = cirsat::phase_policy::saved;
+                }
+                else if ( name == "target" )
+                {
+                    ps.phase = cirsat::phase_policy::target;
+                }
+                else
+                {
+                    std::cout << "Error: Unknown phase policy " << name << std::endl;
+                    return 1;
+                }
+            }
+            else if ( option == "--sim-phase" )
+            {
+                ps.simulation_phase = true;
+            }
+            else if ( option == "--conflicts" && i + 1 < argc )
+            {
+                ps.conflict_limit = std::stoull( argv[++i] );
+            }
+            else if ( option == "--sim-rounds" && i + 1 < argc )
+            {
+                ps.sat_simulation_rounds = static_cast<uint32_t>( std::stoul( argv[++i] ) );
+            }
+            else if ( option == "--strash" )
+            {
+                strash = true;
+            }
+            else if ( option == "--no-strash" )
+            {
+                strash = false;
+            }
+            else if ( option == "--sweep" )
+            {
+                sweep = true;
+            }
+            else if ( option == "--per-output" )
+            {
+                per_output = true;
+            }
+            else if ( option == "--cubes" && i + 1 < argc )
+            {
+                cube_mode = true;
+                cps.num_cubes = static_cast<uint32_t>( std::stoul( argv[++i] ) );
+            }
+            else if ( option == "--dump-cubes" && i + 1 < argc )
+            {
+                cube_mode = true;
+                dump_cubes = argv[++i];
+            }
+            else if ( option == "--cube-file" && i + 1 < argc )
+            {
+                cube_mode = true;
+                cube_file = argv[++i];
+            }
+            else if ( option == "--no-share" )
+            {
+                ps.share_learned = false;
+            }
+            else if ( option == "--threads" && i + 1 < argc )
+            {
+                threads = static_cast<uint32_t>( std::stoul( argv[++i] ) );
+                if ( threads == 0u )
+                {
+                    threads = std::max( 1u, std::thread::hardware_concurrency() );
+                }
+            }
         }
 
         if ( verbose )
@@ -99,14 +265,116 @@ int main( int argc, char* argv[] )
         }
 
         cirsat::Solver solver;
-        if ( !solver.load_aiger( argv[2] ) )
+        if ( !solver.load_aiger( argv[2], strash ) )
         {
             std::cout << "Error: Cannot open or parse file " << argv[2] << std::endl;
             return 1;
         }
 
-        auto [is_sat, solution] = solver.solve();
-        if ( is_sat )
+        if ( sweep )
+        {
+            cirsat::sweep_stats st = solver.sweep( cirsat::sweep_params() );
+            if ( verbose )
+            {
+                std::cout << "[sweep] nodes=" << st.nodes_before << " -> " << st.nodes_after << " classes=" << st.classes
+                          << " proved=" << st.proved << " refuted=" << st.refuted << " undecided=" << st.undecided
+                          << " refinements=" << st.refinements << " time=" << st.seconds << "s\n";
+            }
+        }
+
+        solver.set_params( ps );
+        solver.set_threads( threads );
+        cirsat::solve_result result{ cirsat::sat_status::unknown, std::nullopt };
+        if ( per_output )
+        {
+            std::vector<cirsat::output_report> reports;
+            auto results = cirsat::solve_aig_outputs( solver.network(), ps, threads, reports );
+            for ( size_t i = 0; i < results.size(); ++i )
+            {
+                std::cout << "Output " << i << ": " << statusName( results[i].first ) << "\n";
+                if ( verbose )
+                {
+                    std::cout << "[output] " << i << " cone_nodes=" << reports[i].cone_nodes
+                              << " cone_inputs=" << reports[i].cone_inputs << " time=" << reports[i].seconds << "s\n";
+                    if ( results[i].second )
+                    {
+                        std::cout << "[output] " << i << " solution=";
+                        for ( bool value : *results[i].second )
+                        {
+                            std::cout << ( value ? '1' : '0' );
+                        }
+                        std::cout << "\n";
+                    }
+                }
+            }
+        }
+        else if ( cube_mode )
+        {
+            const auto& network = solver.network();
+            cps.num_threads = threads;
+            std::vector<std::vector<uint32_t>> cubes;
+            std::vector<bool> cube_solution;
+            auto start = std::chrono::steady_clock::now();
+            if ( !cube_file.empty() )
+            {
+                std::ifstream file( cube_file );
+                if ( !file.is_open() || !cirsat::read_cubes( file, network, cubes ) )
+                {
+                    std::cout << "Error: Cannot open or parse cube file " << cube_file << std::endl;
+                    return 1;
+                }
+            }
+            else if ( cirsat::simulate_first( network, ps, cube_solution ) ||
+                      cirsat::generate_cubes( network, ps, cps, cubes, cube_solution ) )
+            {
+                result = { cirsat::sat_status::sat, std::move( cube_solution ) };
+            }
+            if ( verbose && cube_file.empty() )
+            {
+                std::cout << "[cube] lookahead cubes=" << cubes.size() << " time="
+                          << std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count() << "s\n";
+            }
+
+            if ( !dump_cubes.empty() )
+            {
+                std::ofstream file( dump_cubes );
+                cirsat::write_cubes( file, cubes );
+                std::cout << ( result.first == cirsat::sat_status::sat ? "SAT\n" : cubes.empty() ? "UNSAT\n" : "" );
+                return 0;
+            }
+            if ( result.first != cirsat::sat_status::sat )
+            {
+                std::vector<cirsat::cube_report> reports;
+                result = cirsat::solve_cubes( network, ps, cubes, cps.num_threads, reports );
+                if ( verbose )
+                {
+                    const char* names[] = { "unknown", "sat", "unsat" };
+                    double total = 0.0, longest = 0.0;
+                    for ( size_t i = 0; i < reports.size(); ++i )
+                    {
+                        std::cout << "[cube] " << i << " lits=" << cubes[i].size()
+                                  << " result=" << names[static_cast<int>( reports[i].status )]
+                                  << " time=" << reports[i].seconds << "s worker=" << reports[i].worker << "\n";
+                        total += reports[i].seconds;
+                        longest = std::max( longest, reports[i].seconds );
+                    }
+                    std::cout << "[cube] count=" << reports.size() << " total=" << total << "s max=" << longest
+                              << "s\n";
+                }
+            }
+            // refuting the cubes of the file says nothing about the rest of the search space
+            if ( !cube_file.empty() && result.first != cirsat::sat_status::sat )
+            {
+                std::cout << statusName( result.first ) << " (cubes in " << cube_file << ")\n";
+                return 0;
+            }
+        }
+        else
+        {
+            result = solver.solve();
+        }
+        auto& [status, solution] = result;
+        if ( !per_output && status == cirsat::sat_status::sat )
         {
             std::cout << "SAT\n";
             if ( verbose && solution )
@@ -118,21 +386,20 @@ int main( int argc, char* argv[] )
                 }
             }
         }
-        else
+        else if ( !per_output )
         {
-            std::cout << "UNSAT\n";
+            std::cout << statusName( status ) << "\n";
         }
 
         if ( verbose )
         {
             // Enumerate MFFCs
             const auto& network = solver.network();
-            const auto& gates = network.get_gates();
             const auto& inputs = network.get_inputs();
             const auto first_internal = static_cast<cirsat::GateId>( inputs.size() + 1u );
             uint32_t matched = 0u;
 
-            for ( cirsat::GateId root = first_internal; root < gates.size(); ++root )
+            for ( cirsat::GateId root = first_internal; root < network.num_nodes(); ++root )
             {
                 cirsat::mffc_view view{ network, root, limit };
                 if ( view.empty() )
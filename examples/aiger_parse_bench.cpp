@@ -0,0 +1,76 @@
+#include "aig.hpp"
+#include "aiger_mmap_reader.hpp"
+#include "aiger_reader.hpp"
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <lorina/aiger.hpp>
+
+// Load throughput of binary AIGER files, in nodes per second: the lorina callback reader
+// against the memory-mapped parser, both with and without structural hashing.
+// Usage: aiger_parse_bench <file.aig> [<file.aig> ...]
+// e.g. aiger_parse_bench ../benchmarks/aiger/UNSAT/ISCAS85/*.aiger
+
+using namespace cirsat;
+
+template <typename Fn> static double measure( uint32_t rounds, Fn&& fn )
+{
+    auto start = std::chrono::steady_clock::now();
+    for ( uint32_t r = 0; r < rounds; ++r )
+    {
+        fn();
+    }
+    return std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count() / rounds;
+}
+
+int main( int argc, char* argv[] )
+{
+    if ( argc < 2 )
+    {
+        std::cerr << "Usage: " << argv[0] << " <file.aig> [<file.aig> ...]" << std::endl;
+        return 1;
+    }
+
+    constexpr uint32_t rounds = 50u;
+    std::cout << "file, nodes, strash, lorina (Mnodes/s), mmap (Mnodes/s)\n";
+    uint64_t total_nodes = 0u;
+    double total_lorina = 0.0, total_mmap = 0.0;
+    for ( int i = 1; i < argc; ++i )
+    {
+        for ( bool strash : { false, true } )
+        {
+            aig_ntk ntk;
+            bool ok = true;
+            double lorina_time = measure( rounds, [&]() {
+                ntk = aig_ntk();
+                ntk.set_strash( strash );
+                aiger_reader<aig_ntk> reader( ntk );
+                std::ifstream file( argv[i], std::ios::binary );
+                ok &= lorina::read_aiger( file, reader ) == lorina::return_code::success;
+            } );
+            double mmap_time = measure( rounds, [&]() {
+                ntk = aig_ntk();
+                ntk.set_strash( strash );
+                ok &= read_binary_aiger( argv[i], ntk );
+            } );
+            if ( !ok )
+            {
+                std::cerr << "Error: Cannot open or parse file " << argv[i] << std::endl;
+                return 1;
+            }
+
+            const uint32_t num_nodes = ntk.num_nodes();
+            std::cout << argv[i] << ", " << num_nodes << ", " << strash << ", " << num_nodes / lorina_time * 1e-6
+                      << ", " << num_nodes / mmap_time * 1e-6 << "\n";
+            if ( strash )
+            {
+                total_nodes += num_nodes;
+                total_lorina += lorina_time;
+                total_mmap += mmap_time;
+            }
+        }
+    }
+    std::cout << "total (strash), " << total_nodes << ", 1, " << total_nodes / total_lorina * 1e-6 << ", "
+              << total_nodes / total_mmap * 1e-6 << std::endl;
+    return 0;
+}
@@ -0,0 +1,70 @@
+#include "aig_dpll_solver.hpp"
+#include "solver.hpp"
+#include <chrono>
+#include <iostream>
+#include <string>
+
+// Time spent per conflict in aig_dpll_solver::conflict(), which analyzes the conflict,
+// learns a gate and backjumps. Each file is solved twice: the baseline is the plain first-UIP
+// analysis (minimize off), then with recursive minimization of the learned gates. The solver runs
+// with vsids decisions unless --jfrontier is given.
+// Usage: conflict_analysis_bench [--jfrontier] <file.aig> [<file.aig> ...]
+
+using namespace cirsat;
+
+int main( int argc, char* argv[] )
+{
+    aig_dpll_params ps;
+    ps.decision = decision_strategy::vsids;
+    int first = 1;
+    if ( argc > 1 && std::string( argv[1] ) == "--jfrontier" )
+    {
+        ps.decision = decision_strategy::jfrontier_fanout;
+        first = 2;
+    }
+    if ( argc <= first )
+    {
+        std::cerr << "Usage: " << argv[0] << " [--jfrontier] <file.aig> [<file.aig> ...]" << std::endl;
+        return 1;
+    }
+
+    std::cout << "file, analysis, result, conflicts, solve (s), conflict (s), us per conflict\n";
+    double total_time[2] = { 0.0, 0.0 };
+    uint64_t total_conflicts[2] = { 0u, 0u };
+    for ( int i = first; i < argc; ++i )
+    {
+        Solver solver;
+        if ( !solver.load_aiger( argv[i] ) )
+        {
+            std::cerr << "Error: Cannot open or parse file " << argv[i] << std::endl;
+            return 1;
+        }
+
+        for ( bool minimize : { false, true } )
+        {
+            ps.minimize = minimize;
+            aig_dpll_solver dpll( solver.network(), ps );
+            std::vector<bool> solution;
+            auto start = std::chrono::steady_clock::now();
+            bool is_sat = dpll.solve( solution );
+            double elapsed = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+
+            const auto& st = dpll.stats();
+            double per_conflict = st.conflicts ? 1e6 * st.conflict_time / st.conflicts : 0.0;
+            std::cout << argv[i] << ", " << ( minimize ? "minimized" : "baseline" ) << ", "
+                      << ( is_sat ? "SAT" : "UNSAT" ) << ", " << st.conflicts << ", " << elapsed << ", "
+                      << st.conflict_time << ", " << per_conflict << "\n";
+            total_time[minimize] += st.conflict_time;
+            total_conflicts[minimize] += st.conflicts;
+        }
+    }
+
+    for ( bool minimize : { false, true } )
+    {
+        double per_conflict = total_conflicts[minimize] ? 1e6 * total_time[minimize] / total_conflicts[minimize] : 0.0;
+        std::cout << "total, " << ( minimize ? "minimized" : "baseline" ) << ", , " << total_conflicts[minimize]
+                  << ", , " << total_time[minimize] << ", " << per_conflict << "\n";
+    }
+
+    return 0;
+}
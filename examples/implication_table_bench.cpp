@@ -0,0 +1,119 @@
+#include "aig.hpp"
+#include "solver.hpp"
+#include <chrono>
+#include <iostream>
+#include <unordered_map>
+#include <vector>
+
+// Micro-benchmark of the direct implication table: the previous hash map layout
+// against the CSR layout built by aig_ntk::build_direct_implication_table.
+// Usage: implication_table_bench <file.aig> [<file.aig> ...]
+
+using namespace cirsat;
+
+using Hashed_ImplicationTable = std::unordered_map<GateId, std::array<std::vector<std::pair<GateId, bool>>, 2>>;
+
+static void build_hashed( const aig_ntk& ntk, Hashed_ImplicationTable& ditable )
+{
+    for ( GateId id = ntk.get_inputs().size() + 1; id < ntk.num_nodes(); ++id )
+    {
+        const auto& children = ntk.get_children( id );
+        GateId a = aig_ntk::data_to_index( children[0] );
+        GateId b = aig_ntk::data_to_index( children[1] );
+        bool a_wv = !aig_ntk::data_to_complement( children[0] );
+        bool b_wv = !aig_ntk::data_to_complement( children[1] );
+        ditable[a][!a_wv].emplace_back( id, false );
+        ditable[b][!b_wv].emplace_back( id, false );
+        ditable[id][1].emplace_back( a, a_wv );
+        ditable[id][1].emplace_back( b, b_wv );
+    }
+}
+
+template <typename Fn> static double measure( uint32_t rounds, Fn&& fn )
+{
+    auto start = std::chrono::steady_clock::now();
+    for ( uint32_t r = 0; r < rounds; ++r )
+    {
+        fn();
+    }
+    return std::chrono::duration<double, std::micro>( std::chrono::steady_clock::now() - start ).count() / rounds;
+}
+
+int main( int argc, char* argv[] )
+{
+    if ( argc < 2 )
+    {
+        std::cerr << "Usage: " << argv[0] << " <file.aig> [<file.aig> ...]" << std::endl;
+        return 1;
+    }
+
+    constexpr uint32_t rounds = 100u;
+    std::cout << "file, nodes, hashed build (us), csr build (us), hashed lookup (us), csr lookup (us)\n";
+    for ( int i = 1; i < argc; ++i )
+    {
+        Solver solver;
+        if ( !solver.load_aiger( argv[i] ) )
+        {
+            std::cerr << "Error: Cannot open or parse file " << argv[i] << std::endl;
+            return 1;
+        }
+        const auto& ntk = solver.network();
+        const GateId num_nodes = ntk.num_nodes();
+
+        Hashed_ImplicationTable hashed;
+        double hashed_build = measure( rounds, [&]() {
+            hashed.clear();
+            build_hashed( ntk, hashed );
+        } );
+
+        Direct_ImplicationTable csr;
+        double csr_build = measure( rounds, [&]() {
+            csr = Direct_ImplicationTable();
+            ntk.build_direct_implication_table( csr );
+        } );
+
+        // visit the implications of every ( node, value ) pair, as BCP does once per assignment
+        uint64_t hashed_sum = 0, csr_sum = 0;
+        double hashed_lookup = measure( rounds, [&]() {
+            for ( GateId id = 0; id < num_nodes; ++id )
+            {
+                auto it = hashed.find( id );
+                if ( it == hashed.end() )
+                {
+                    continue;
+                }
+                for ( int val = 0; val < 2; ++val )
+                {
+                    for ( const auto& [next, next_val] : it->second[val] )
+                    {
+                        hashed_sum += next + next_val;
+                    }
+                }
+            }
+        } );
+        double csr_lookup = measure( rounds, [&]() {
+            for ( GateId id = 0; id < num_nodes; ++id )
+            {
+                for ( int val = 0; val < 2; ++val )
+                {
+                    for ( uint32_t edge : csr.implications( id, val ) )
+                    {
+                        csr_sum += Direct_ImplicationTable::edge_target( edge ) +
+                                   Direct_ImplicationTable::edge_value( edge );
+                    }
+                }
+            }
+        } );
+
+        if ( hashed_sum != csr_sum )
+        {
+            std::cerr << "Error: layouts disagree on " << argv[i] << std::endl;
+            return 1;
+        }
+
+        std::cout << argv[i] << ", " << num_nodes << ", " << hashed_build << ", " << csr_build << ", "
+                  << hashed_lookup << ", " << csr_lookup << "\n";
+    }
+
+    return 0;
+}
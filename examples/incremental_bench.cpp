@@ -0,0 +1,72 @@
+#include "aig.hpp"
+#include "aig_dpll_solver.hpp"
+#include "solver.hpp"
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+
+// Random queries of a few assumptions, literals of random nodes, on a circuit, answered by one
+// incremental solver and by a fresh solver per query.
+// Usage: incremental_bench [--queries <N>] <file.aig> [<file.aig> ...]
+
+using namespace cirsat;
+
+int main( int argc, char* argv[] )
+{
+    uint32_t num_queries = 1000u;
+    int first = 1;
+    if ( argc > 2 && std::string( argv[1] ) == "--queries" )
+    {
+        num_queries = static_cast<uint32_t>( std::stoul( argv[2] ) );
+        first = 3;
+    }
+    if ( first >= argc )
+    {
+        std::cerr << "Usage: " << argv[0] << " [--queries <N>] <file.aig> [<file.aig> ...]" << std::endl;
+        return 1;
+    }
+
+    constexpr uint32_t max_assumptions = 4u;
+    std::cout << "file, nodes, queries, sat, incremental s, fresh s, incremental conflicts\n";
+    for ( int i = first; i < argc; ++i )
+    {
+        Solver solver;
+        if ( !solver.load_aiger( argv[i] ) )
+        {
+            std::cerr << "Error: Cannot open or parse file " << argv[i] << std::endl;
+            return 1;
+        }
+        const auto& ntk = solver.network();
+
+        aig_dpll_solver incremental( ntk );
+        std::mt19937 rng( 0u );
+        std::vector<uint32_t> assumptions;
+        std::vector<bool> solution;
+        uint32_t num_sat = 0u;
+        double incremental_seconds = 0.0, fresh_seconds = 0.0;
+        for ( uint32_t q = 0; q < num_queries; ++q )
+        {
+            assumptions.clear();
+            for ( uint32_t k = 1u + rng() % max_assumptions; k > 0u; --k )
+            {
+                GateId id = 1u + rng() % ( ntk.num_nodes() - 1u );
+                bool complement = rng() & 1u;
+                assumptions.push_back( ( id << 1 ) | ( complement ? 1u : 0u ) );
+            }
+
+            auto start = std::chrono::steady_clock::now();
+            num_sat += incremental.solve( solution, assumptions ) ? 1u : 0u;
+            auto middle = std::chrono::steady_clock::now();
+            aig_dpll_solver fresh( ntk );
+            fresh.solve( solution, assumptions );
+            auto end = std::chrono::steady_clock::now();
+            incremental_seconds += std::chrono::duration<double>( middle - start ).count();
+            fresh_seconds += std::chrono::duration<double>( end - middle ).count();
+        }
+
+        std::cout << argv[i] << ", " << ntk.num_nodes() << ", " << num_queries << ", " << num_sat << ", "
+                  << incremental_seconds << ", " << fresh_seconds << ", " << incremental.stats().conflicts << "\n";
+    }
+    return 0;
+}
@@ -38,7 +38,8 @@ int main()
     }
 
     std::cout << "Solving circuit..." << std::endl;
-    auto [is_sat, solution] = solver.solve();
+    auto [status, solution] = solver.solve();
+    bool is_sat = status == cirsat::sat_status::sat;
 
     std::cout << "Result: " << ( is_sat ? "SAT" : "UNSAT" ) << std::endl;
 
@@ -0,0 +1,72 @@
+#include "aig.hpp"
+#include "aig_simulator.hpp"
+#include "solver.hpp"
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+
+// Throughput of the bit-parallel random simulation, and the first pattern satisfying every
+// output when there is one.
+// Usage: simulation_bench [--words <N>] <file.aig> [<file.aig> ...]
+
+using namespace cirsat;
+
+int main( int argc, char* argv[] )
+{
+    uint32_t num_words = 64u;
+    int first = 1;
+    if ( argc > 2 && std::string( argv[1] ) == "--words" )
+    {
+        num_words = static_cast<uint32_t>( std::stoul( argv[2] ) );
+        first = 3;
+    }
+    if ( first >= argc )
+    {
+        std::cerr << "Usage: " << argv[0] << " [--words <N>] <file.aig> [<file.aig> ...]" << std::endl;
+        return 1;
+    }
+
+    constexpr uint32_t rounds = 64u;
+    std::cout << "file, nodes, patterns, Mpatterns/s, Gnode-patterns/s, first satisfying pattern\n";
+    for ( int i = first; i < argc; ++i )
+    {
+        Solver solver;
+        if ( !solver.load_aiger( argv[i] ) )
+        {
+            std::cerr << "Error: Cannot open or parse file " << argv[i] << std::endl;
+            return 1;
+        }
+        const auto& ntk = solver.network();
+
+        aig_simulator sim( ntk, num_words );
+        std::mt19937_64 rng( 0u );
+        int64_t hit = -1;
+        double seconds = 0.0;
+        for ( uint32_t r = 0; r < rounds; ++r )
+        {
+            sim.randomize_inputs( rng );
+            auto start = std::chrono::steady_clock::now();
+            sim.simulate();
+            seconds += std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+            int64_t pattern = sim.find_satisfying_pattern();
+            if ( hit < 0 && pattern >= 0 )
+            {
+                hit = static_cast<int64_t>( r * sim.num_patterns() ) + pattern;
+            }
+        }
+
+        double patterns = static_cast<double>( rounds ) * sim.num_patterns();
+        std::cout << argv[i] << ", " << ntk.num_nodes() << ", " << patterns << ", " << patterns / seconds * 1e-6 << ", "
+                  << patterns * ntk.num_nodes() / seconds * 1e-9 << ", ";
+        if ( hit >= 0 )
+        {
+            std::cout << hit << "\n";
+        }
+        else
+        {
+            std::cout << "none\n";
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,136 @@
+/**
+ * @file activity_heap.hpp
+ * @brief Binary max-heap of nodes ordered by activity, used for decisions
+ * @copyright Copyright (c) 2023- Zhufei Chu, Ningbo University. MIT License.
+ */
+
+#ifndef CIRSAT_ACTIVITY_HEAP_HPP
+#define CIRSAT_ACTIVITY_HEAP_HPP
+
+#include "aig.hpp"
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+namespace cirsat {
+
+// Heap over node ids keyed by an external activity array. Nodes are not removed when they
+// get assigned, the solver skips them when popping and inserts them again on backtrack.
+class activity_heap
+{
+  public:
+    explicit activity_heap( const std::vector<double>& activity ) : m_activity( activity )
+    {
+    }
+
+    void resize( size_t num_nodes )
+    {
+        m_index.resize( num_nodes, NULL_INDEX );
+    }
+
+    bool empty() const
+    {
+        return m_heap.empty();
+    }
+
+    bool contains( GateId id ) const
+    {
+        return id < m_index.size() && m_index[id] != NULL_INDEX;
+    }
+
+    GateId top() const
+    {
+        assert( !m_heap.empty() );
+        return m_heap[0];
+    }
+
+    void insert( GateId id )
+    {
+        if ( contains( id ) )
+        {
+            return;
+        }
+        m_index[id] = static_cast<uint32_t>( m_heap.size() );
+        m_heap.push_back( id );
+        percolate_up( m_index[id] );
+    }
+
+    // Restore the heap order after the activity of id has been increased
+    void increase( GateId id )
+    {
+        if ( contains( id ) )
+        {
+            percolate_up( m_index[id] );
+        }
+    }
+
+    GateId pop()
+    {
+        GateId id = m_heap[0];
+        m_heap[0] = m_heap.back();
+        m_index[m_heap[0]] = 0u;
+        m_index[id] = NULL_INDEX;
+        m_heap.pop_back();
+        if ( m_heap.size() > 1u )
+        {
+            percolate_down( 0u );
+        }
+        return id;
+    }
+
+  private:
+    bool before( GateId a, GateId b ) const
+    {
+        return m_activity[a] > m_activity[b];
+    }
+
+    void percolate_up( uint32_t i )
+    {
+        GateId id = m_heap[i];
+        while ( i > 0u )
+        {
+            uint32_t parent = ( i - 1u ) >> 1;
+            if ( !before( id, m_heap[parent] ) )
+            {
+                break;
+            }
+            m_heap[i] = m_heap[parent];
+            m_index[m_heap[i]] = i;
+            i = parent;
+        }
+        m_heap[i] = id;
+        m_index[id] = i;
+    }
+
+    void percolate_down( uint32_t i )
+    {
+        GateId id = m_heap[i];
+        uint32_t size = static_cast<uint32_t>( m_heap.size() );
+        while ( 2u * i + 1u < size )
+        {
+            uint32_t child = 2u * i + 1u;
+            if ( child + 1u < size && before( m_heap[child + 1u], m_heap[child] ) )
+            {
+                ++child;
+            }
+            if ( !before( m_heap[child], id ) )
+            {
+                break;
+            }
+            m_heap[i] = m_heap[child];
+            m_index[m_heap[i]] = i;
+            i = child;
+        }
+        m_heap[i] = id;
+        m_index[id] = i;
+    }
+
+  private:
+    const std::vector<double>& m_activity;
+    std::vector<GateId> m_heap;
+    std::vector<uint32_t> m_index;
+};
+
+} // namespace cirsat
+
+#endif // CIRSAT_ACTIVITY_HEAP_HPP
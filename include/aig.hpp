@@ -1,10 +1,12 @@
 #ifndef CIRSAT_AIG_HPP
 #define CIRSAT_AIG_HPP
 
+#include "strash_table.hpp"
 #include <array>
 #include <cassert>
 #include <cstdint>
 #include <iostream>
+#include <limits>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
@@ -16,23 +18,57 @@ namespace cirsat {
 enum class GateType { AND, OR, NOT, NAND, NOR, XOR, XNOR, BUF, MUX, UNKNOWN };
 
 using GateId = uint32_t;
-using Direct_ImplicationTable = std::unordered_map<GateId, std::array<std::vector<std::pair<GateId, bool>>, 2>>;
 using Indirect_ImplicationTable = std::array<std::vector<std::vector<GateId>>, 2>;
 constexpr uint32_t INVALID_GATE = std::numeric_limits<uint32_t>::max();
-struct Watch_Values {
-    bool input1;
-    bool input2;
-    bool output;
+
+// Contiguous run of ids or edges inside a compressed sparse row array
+struct index_range {
+    const uint32_t* first;
+    const uint32_t* last;
+
+    const uint32_t* begin() const
+    {
+        return first;
+    }
+    const uint32_t* end() const
+    {
+        return last;
+    }
+    size_t size() const
+    {
+        return last - first;
+    }
 };
 
-struct gate {
-    GateType type = GateType::AND;
-    std::array<uint8_t, 2u> info{ 0, 0 }; // [0]--number of fanouts; [1]--visited flag
-    std::array<GateId, 2u> children{ NULL_INDEX, NULL_INDEX };
-    std::vector<GateId> outputs;
-    std::vector<GateId> fanins;
-    float activity = 0.0f;
+// Direct implications in compressed sparse row layout, indexed by GateId.
+// If node n takes value v, every edge in edges[v][offsets[v][n]..offsets[v][n + 1]) is implied,
+// an edge being packed as ( target << 1 ) | target_value.
+struct Direct_ImplicationTable {
+    using range = index_range;
+
+    std::array<std::vector<uint32_t>, 2> offsets;
+    std::array<std::vector<uint32_t>, 2> edges;
+
+    range implications( GateId id, bool val ) const
+    {
+        const uint32_t* base = edges[val].data();
+        return { base + offsets[val][id], base + offsets[val][id + 1] };
+    }
+
+    static GateId edge_target( uint32_t edge )
+    {
+        return edge >> 1;
+    }
+
+    static bool edge_value( uint32_t edge )
+    {
+        return edge & 1;
+    }
+};
 
+// Literal of a node: its index and a complement flag packed in data. The nodes themselves are
+// stored by aig_ntk in structure of arrays form.
+struct gate {
     union {
         struct {
             uint32_t complement : 1;
@@ -81,50 +117,94 @@ struct gate {
     }
 };
 
+// AIG stored as structure of arrays: node 0 is the constant, the primary inputs follow and
+// every AND gate comes after its fanins. The fanins of node n are the two literals children[n],
+// its fanouts are a range of a CSR array built by build_fanouts() once the network is complete.
 class aig_ntk
 {
   public:
     aig_ntk() = default;
 
+    void create_constant()
+    {
+        assert( m_children.empty() );
+        add_node( NULL_INDEX, NULL_INDEX );
+    }
+
     void create_pi()
     {
-        const auto index = m_gates.size();
-        m_gates.emplace_back( index, 0 );
-        auto& node = m_gates.back();
-        node.children[0] = node.children[1] = index;
-        m_inputs.push_back( index );
+        m_inputs.push_back( num_nodes() );
+        add_node( NULL_INDEX, NULL_INDEX );
     }
 
     void create_po( const gate& s )
     {
-        m_gates[s.index].info[0]++;
-        m_outputs.push_back( s.data );
+        create_po_lit( s.data );
     }
 
-    void create_and( const gate& a, const gate& b )
+    void create_po_lit( uint32_t lit )
+    {
+        m_num_refs[lit >> 1]++;
+        m_outputs.push_back( lit );
+    }
+
+    // Literal of a AND b. With structural hashing trivial gates are simplified and an existing
+    // gate with the same fanins is returned, otherwise a new node is always appended.
+    gate create_and( const gate& a, const gate& b )
+    {
+        return gate( create_and_lit( a.data, b.data ) );
+    }
+
+    // create_and on plain literals, ( index << 1 ) | complement, as used by the AIGER readers
+    uint32_t create_and_lit( uint32_t a, uint32_t b )
     {
         /* order inputs */
-        gate left = a, right = b;
-        if ( left.index > right.index )
+        uint32_t left = a, right = b;
+        if ( ( left >> 1 ) > ( right >> 1 ) )
         {
             std::swap( left, right );
         }
 
-        assert( left.index != right.index && "AND gate cannot have same inputs" );
+        if ( m_strash )
+        {
+            // the constant node has index 0, so it is always on the left
+            if ( left == 0u || left == ( right ^ 1u ) )
+            {
+                return 0u;
+            }
+            if ( left == 1u || left == right )
+            {
+                return right;
+            }
+            uint32_t existing = m_strash_table.find( left, right );
+            if ( existing != strash_table::EMPTY )
+            {
+                return existing << 1;
+            }
+            m_strash_table.insert( left, right, num_nodes() );
+        }
+
+        assert( ( left >> 1 ) != ( right >> 1 ) && "AND gate cannot have same inputs" );
 
-        gate node;
-        node.children[0] = left.data;
-        node.children[1] = right.data;
+        m_num_refs[left >> 1]++;
+        m_num_refs[right >> 1]++;
+        add_node( left, right );
+        return ( num_nodes() - 1 ) << 1;
+    }
 
-        const auto index = m_gates.size();
-        node.index = index;
-        node.complement = 0;
-        m_gates.emplace_back( node );
+    // Structural hashing of the following create_and calls, gates created before are not hashed
+    void set_strash( bool strash )
+    {
+        m_strash = strash;
+        if ( !strash )
+        {
+            m_strash_table.clear();
+        }
+    }
 
-        m_gates[left.index].info[0]++;
-        m_gates[left.index].outputs.push_back( index );
-        m_gates[right.index].info[0]++;
-        m_gates[right.index].outputs.push_back( index );
+    bool is_strash() const
+    {
+        return m_strash;
     }
 
     gate create_not( const gate& a ) const
@@ -132,6 +212,34 @@ class aig_ntk
         return !a;
     }
 
+    // Fanout CSR of the AND gates, to be called after the last create_and
+    void build_fanouts()
+    {
+        const GateId n = num_nodes();
+        m_fanout_offsets.assign( n + 1, 0u );
+        for ( GateId id = m_inputs.size() + 1; id < n; ++id )
+        {
+            m_fanout_offsets[data_to_index( m_children[id][0] ) + 1]++;
+            m_fanout_offsets[data_to_index( m_children[id][1] ) + 1]++;
+        }
+        for ( GateId id = 0; id < n; ++id )
+        {
+            m_fanout_offsets[id + 1] += m_fanout_offsets[id];
+        }
+        m_fanouts.resize( m_fanout_offsets.back() );
+        std::vector<uint32_t> fill( m_fanout_offsets.begin(), m_fanout_offsets.end() - 1 );
+        for ( GateId id = m_inputs.size() + 1; id < n; ++id )
+        {
+            m_fanouts[fill[data_to_index( m_children[id][0] )]++] = id;
+            m_fanouts[fill[data_to_index( m_children[id][1] )]++] = id;
+        }
+    }
+
+    bool has_fanouts() const
+    {
+        return m_fanout_offsets.size() == m_children.size() + 1;
+    }
+
     const std::vector<GateId>& get_inputs() const
     {
         return m_inputs;
@@ -140,9 +248,41 @@ class aig_ntk
     {
         return m_outputs;
     }
-    const std::vector<gate>& get_gates() const
+
+    // Number of nodes, including the constant and the primary inputs
+    GateId num_nodes() const
+    {
+        return static_cast<GateId>( m_children.size() );
+    }
+
+    bool is_pi( GateId id ) const
+    {
+        return id >= 1u && id <= m_inputs.size();
+    }
+
+    bool is_and( GateId id ) const
+    {
+        return id > m_inputs.size();
+    }
+
+    // Fanin literals of an AND gate, ordered by node index
+    const std::array<uint32_t, 2u>& get_children( GateId id ) const
+    {
+        return m_children[id];
+    }
+
+    // AND gates having id as a fanin, requires build_fanouts()
+    index_range get_fanouts( GateId id ) const
+    {
+        assert( has_fanouts() );
+        const GateId* base = m_fanouts.data();
+        return { base + m_fanout_offsets[id], base + m_fanout_offsets[id + 1] };
+    }
+
+    // References to id from AND gates and primary outputs
+    uint32_t get_num_refs( GateId id ) const
     {
-        return m_gates;
+        return m_num_refs[id];
     }
 
     const void set_num_pis( const uint32_t& num_pis )
@@ -156,15 +296,16 @@ class aig_ntk
         m_num_pos = num_pos;
         m_outputs.reserve( num_pos );
     }
+    // Expected number of AND gates, structural hashing may create fewer
     const void set_num_gates( const uint32_t& num_gates )
     {
         m_num_gates = num_gates;
-        m_gates.reserve( num_gates );
-    }
-
-    const void add_gate( const gate& gate )
-    {
-        m_gates.push_back( gate );
+        m_children.reserve( m_num_pis + num_gates + 1 );
+        m_num_refs.reserve( m_num_pis + num_gates + 1 );
+        if ( m_strash )
+        {
+            m_strash_table.reserve( num_gates );
+        }
     }
 
     uint32_t get_num_pis() const
@@ -192,77 +333,79 @@ class aig_ntk
         return data & 1;
     }
 
-    GateId create_or_learning_gate( const std::vector<GateId>& inputs, const std::vector<bool>& watched_values,
-                                    Indirect_ImplicationTable& iitable,
-                                    std::unordered_map<GateId, std::vector<bool>>& learn_watch_vals )
+    // value of the fanin node that sets the AND fanin literal data to 1
+    static bool watch_value( uint32_t data )
     {
-        assert( !inputs.empty() );
-        assert( inputs.size() == watched_values.size() );
-        gate node;
-        node.type = GateType::OR;
-
-        GateId new_id = m_gates.size();
-        node.index = new_id;
-        node.complement = 0;
-
-        node.children[0] = inputs[0];
-        node.children[1] = inputs.size() > 1 ? inputs[1] : inputs[0];
+        return !( data & 1 );
+    }
 
-        node.fanins = inputs;
+    void build_direct_implication_table( Direct_ImplicationTable& ditable ) const
+    {
+        size_t num_gates = num_nodes();
+        GateId first_gate = m_inputs.size() + 1;
 
-        for ( GateId in : inputs )
+        // first pass: count the implications of every ( node, value ) pair
+        for ( int val = 0; val < 2; val++ )
         {
-            m_gates[in].outputs.push_back( new_id );
-            m_gates[in].info[0]++;
+            ditable.offsets[val].assign( num_gates + 1, 0u );
         }
-
-        m_gates.push_back( node );
-
-        std::vector<bool> wv( inputs.size() );
-        for ( size_t i = 0; i < inputs.size(); i++ )
-            wv[i] = watched_values[i];
-        learn_watch_vals[new_id] = std::move( wv );
-
-        for ( size_t i = 0; i < inputs.size(); i++ )
+        for ( GateId id = first_gate; id < num_gates; ++id )
+        {
+            const auto& children = m_children[id];
+            ditable.offsets[data_to_complement( children[0] )][data_to_index( children[0] ) + 1]++;
+            ditable.offsets[data_to_complement( children[1] )][data_to_index( children[1] ) + 1]++;
+            ditable.offsets[1][id + 1] += 2;
+        }
+        for ( int val = 0; val < 2; val++ )
         {
-            GateId in = inputs[i];
-            bool watch_val = watched_values[i];
-            iitable[watch_val][in].push_back( new_id );
+            auto& offsets = ditable.offsets[val];
+            for ( size_t i = 1; i < offsets.size(); ++i )
+            {
+                offsets[i] += offsets[i - 1];
+            }
+            ditable.edges[val].resize( offsets.back() );
         }
 
-        return new_id;
+        // second pass: fill the edges in gate order
+        std::array<std::vector<uint32_t>, 2> fill{ ditable.offsets[0], ditable.offsets[1] };
+        auto add_edge = [&]( GateId from, bool from_val, GateId to, bool to_val ) {
+            ditable.edges[from_val][fill[from_val][from]++] = ( to << 1 ) | ( to_val ? 1u : 0u );
+        };
+        for ( GateId id = first_gate; id < num_gates; ++id )
+        {
+            const auto& children = m_children[id];
+            GateId a = data_to_index( children[0] );
+            GateId b = data_to_index( children[1] );
+            bool a_wv = !data_to_complement( children[0] );
+            bool b_wv = !data_to_complement( children[1] );
+            // if a/b==0, then z = 0
+            add_edge( a, !a_wv, id, false );
+            add_edge( b, !b_wv, id, false );
+            // if z==1, then a==1&b==1
+            add_edge( id, true, a, a_wv );
+            add_edge( id, true, b, b_wv );
+        }
     }
 
-    void build_implication_table( Direct_ImplicationTable& ditable, Indirect_ImplicationTable& iitable,
-                                  std::unordered_map<GateId, Watch_Values>& watch_vals ) const
+    // The watch values of an AND gate are implied by its fanin literals: a fanin matches when
+    // the literal is 1 and the output matches when it is 0, see watch_value()
+    void build_implication_table( Direct_ImplicationTable& ditable, Indirect_ImplicationTable& iitable ) const
     {
-        size_t num_gates = m_gates.size();
+        build_direct_implication_table( ditable );
+
+        size_t num_gates = num_nodes();
         for ( int val = 0; val < 2; val++ )
         {
             iitable[val].resize( num_gates );
         }
-        for ( GateId id = m_inputs.size() + 1; id < m_gates.size(); ++id )
+        for ( GateId id = m_inputs.size() + 1; id < num_gates; ++id )
         {
-            const gate& g = m_gates[id];
-            GateId a = data_to_index( g.children[0] );
-            GateId b = data_to_index( g.children[1] );
-            bool a_neg = data_to_complement( g.children[0] );
-            bool b_neg = data_to_complement( g.children[1] );
-            watch_vals[id].input1 = !a_neg;
-            watch_vals[id].input2 = !b_neg;
-            watch_vals[id].output = false;
-
-            bool is_output = false;
-            GateId po_data;
-            bool a_wv = watch_vals[id].input1;
-            bool b_wv = watch_vals[id].input2;
-            bool id_wv = watch_vals[id].output;
-            // if a/b==0, then z = 0
-            ditable[a][!a_wv].emplace_back( id, id_wv );
-            ditable[b][!b_wv].emplace_back( id, id_wv );
-            // if z==1, then a==1&b==1
-            ditable[id][!id_wv].emplace_back( a, a_wv );
-            ditable[id][!id_wv].emplace_back( b, b_wv );
+            const auto& children = m_children[id];
+            GateId a = data_to_index( children[0] );
+            GateId b = data_to_index( children[1] );
+            bool a_wv = watch_value( children[0] );
+            bool b_wv = watch_value( children[1] );
+            bool id_wv = false;
 
             // if a==1&&b==1, then z==1,is not here, indirect_implication
 
@@ -273,12 +416,26 @@ class aig_ntk
     }
 
   private:
-    std::vector<gate> m_gates;
+    void add_node( uint32_t left, uint32_t right )
+    {
+        m_children.push_back( { left, right } );
+        m_num_refs.push_back( 0u );
+        m_fanout_offsets.clear();
+    }
+
+  private:
+    // per node: fanin literals, number of references; fanout CSR of the AND gates
+    std::vector<std::array<uint32_t, 2u>> m_children;
+    std::vector<uint32_t> m_num_refs;
+    std::vector<uint32_t> m_fanout_offsets;
+    std::vector<GateId> m_fanouts;
     std::vector<GateId> m_inputs;
     std::vector<GateId> m_outputs;
     uint32_t m_num_pis{ 0u };
     uint32_t m_num_pos{ 0u };
     uint32_t m_num_gates{ 0u };
+    bool m_strash{ false };
+    strash_table m_strash_table;
 };
 
 } // namespace cirsat
@@ -0,0 +1,107 @@
+/**
+ * @file aig_cone.hpp
+ * @brief Extraction of the transitive fanin cone of a set of literals
+ * @copyright Copyright (c) 2023- Zhufei Chu, Ningbo University. MIT License.
+ */
+
+#ifndef CIRSAT_AIG_CONE_HPP
+#define CIRSAT_AIG_CONE_HPP
+
+#include "aig.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace cirsat {
+
+// Copy the transitive fanin cone of roots, literals of ntk, into cone, which must be empty. The
+// nodes are densely renumbered in their order in ntk: the constant, then the inputs, then the
+// AND gates. With all_inputs every input of ntk is kept, so that input i is the same in both
+// networks; otherwise only the inputs of the cone are, and inputs receives the ntk node of each
+// of them. Returns the literals of the roots in cone, the caller creates the outputs and builds
+// the fanouts.
+inline std::vector<uint32_t> extract_cone( const aig_ntk& ntk, const std::vector<uint32_t>& roots, aig_ntk& cone,
+                                           bool all_inputs = false, std::vector<GateId>* inputs = nullptr )
+{
+    std::vector<uint32_t> node_map( ntk.num_nodes(), NULL_INDEX );
+    std::vector<GateId> nodes;
+    std::vector<GateId> stack;
+    for ( uint32_t root : roots )
+    {
+        stack.push_back( aig_ntk::data_to_index( root ) );
+    }
+    // node_map doubles as the visited mark until the nodes are numbered
+    while ( !stack.empty() )
+    {
+        GateId id = stack.back();
+        stack.pop_back();
+        if ( id == 0u || node_map[id] != NULL_INDEX )
+        {
+            continue;
+        }
+        node_map[id] = 0u;
+        nodes.push_back( id );
+        if ( ntk.is_and( id ) )
+        {
+            for ( uint32_t child : ntk.get_children( id ) )
+            {
+                stack.push_back( aig_ntk::data_to_index( child ) );
+            }
+        }
+    }
+    std::sort( nodes.begin(), nodes.end() );
+
+    auto first_gate = std::find_if( nodes.begin(), nodes.end(), [&]( GateId id ) { return ntk.is_and( id ); } );
+    const uint32_t num_inputs =
+        all_inputs ? static_cast<uint32_t>( ntk.get_inputs().size() ) : static_cast<uint32_t>( first_gate - nodes.begin() );
+
+    cone.set_strash( true );
+    cone.set_num_pis( num_inputs );
+    cone.set_num_pos( static_cast<uint32_t>( roots.size() ) );
+    cone.set_num_gates( static_cast<uint32_t>( nodes.end() - first_gate ) );
+    cone.create_constant();
+    node_map[0] = 0u;
+    if ( inputs != nullptr )
+    {
+        inputs->clear();
+    }
+    if ( all_inputs )
+    {
+        for ( GateId pi : ntk.get_inputs() )
+        {
+            node_map[pi] = cone.num_nodes() << 1;
+            cone.create_pi();
+        }
+    }
+    else
+    {
+        for ( auto it = nodes.begin(); it != first_gate; ++it )
+        {
+            node_map[*it] = cone.num_nodes() << 1;
+            cone.create_pi();
+            if ( inputs != nullptr )
+            {
+                inputs->push_back( *it );
+            }
+        }
+    }
+
+    auto map_lit = [&]( uint32_t lit ) { return node_map[aig_ntk::data_to_index( lit )] ^ ( lit & 1u ); };
+    for ( auto it = first_gate; it != nodes.end(); ++it )
+    {
+        const auto& children = ntk.get_children( *it );
+        node_map[*it] = cone.create_and_lit( map_lit( children[0] ), map_lit( children[1] ) );
+    }
+
+    std::vector<uint32_t> cone_roots;
+    cone_roots.reserve( roots.size() );
+    for ( uint32_t root : roots )
+    {
+        cone_roots.push_back( map_lit( root ) );
+    }
+    return cone_roots;
+}
+
+} // namespace cirsat
+
+#endif // CIRSAT_AIG_CONE_HPP
@@ -7,101 +7,396 @@
 #ifndef CIRSAT_AIG_DPLL_SOLVER_HPP
 #define CIRSAT_AIG_DPLL_SOLVER_HPP
 
+#include "activity_heap.hpp"
 #include "aig.hpp"
+#include "aig_simulator.hpp"
+#include "learned_db.hpp"
+#include "learned_exchange.hpp"
+#include "sat_status.hpp"
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
 #include <ctime>
+#include <memory>
 #include <optional>
+#include <random>
 namespace cirsat {
 
+// How the learned gate database is reduced
+enum class reduce_policy {
+    none,      // keep every learned gate
+    activity,  // remove the less active half
+    keep_glue, // as activity, but gates with LBD <= glue_lbd are never removed
+    tiered     // core ( LBD <= glue_lbd ) is kept, tier2 ( LBD <= tier2_lbd ) while it is used, local by activity
+};
+
+// How the next decision node is chosen
+enum class decision_strategy {
+    jfrontier_fanout, // unassigned fanin of the J-frontier with the largest fanout
+    vsids             // unassigned node with the highest conflict activity ( EVSIDS )
+};
+
+// When the search restarts from decision level 0
+enum class restart_policy {
+    none,
+    luby,      // restart_base * luby( i ) conflicts between restarts
+    geometric, // restart_base * restart_inc^i conflicts between restarts
+    glucose    // when the fast moving average of learned LBDs exceeds restart_margin times the slow one
+};
+
+// Which value a decision node takes
+enum class phase_policy {
+    fixed,  // always the initial phase
+    saved,  // value the node had before it was last unassigned
+    target  // saved phases, preferring the longest conflict-free assignment, with periodic rephasing
+};
+
+struct aig_dpll_params {
+    decision_strategy decision{ decision_strategy::jfrontier_fanout };
+    // decay factor of the node activities used by vsids
+    double var_decay{ 0.95 };
+
+    reduce_policy reduce{ reduce_policy::tiered };
+    // conflicts before the first reduction, and growth of the interval after each reduction
+    uint32_t reduce_first{ 2000u };
+    uint32_t reduce_inc{ 300u };
+    uint32_t glue_lbd{ 2u };
+    uint32_t tier2_lbd{ 6u };
+    // decay factor of the learned gate activities
+    double learned_decay{ 0.999 };
+
+    phase_policy phase{ phase_policy::saved };
+    // initial phases: false, or the majority value of each node under random simulation
+    bool simulation_phase{ false };
+    uint32_t simulation_words{ 16u };
+    uint64_t seed{ 0u };
+    // SAT fast path of the drivers, see simulate_first: rounds of 64 * sat_simulation_words random
+    // patterns on the whole network before any solver is built, 0 disables it. aig_dpll_solver
+    // itself never simulates, so portfolio members, cubes and cones do not repeat it.
+    uint32_t sat_simulation_rounds{ 16u };
+    uint32_t sat_simulation_words{ 4u };
+    // conflicts between two rephasings of the target policy, the interval grows linearly
+    uint32_t rephase_interval{ 1000u };
+
+    // remove nodes of learned gates that are implied by the other ones
+    bool minimize{ true };
+
+    // give up after this many conflicts in one call to solve, which then returns false with
+    // interrupted() set and the drivers report sat_status::unknown; 0 is unlimited
+    uint64_t conflict_limit{ 0u };
+
+    restart_policy restart{ restart_policy::glucose };
+    uint32_t restart_base{ 100u };
+    double restart_inc{ 1.5 };
+    // glucose restarts: smoothing factors of the LBD averages, margin and minimal conflicts between restarts
+    double restart_ema_fast{ 1.0 / 32 };
+    double restart_ema_slow{ 1.0 / 4096 };
+    double restart_margin{ 1.25 };
+    uint32_t restart_min_conflicts{ 50u };
+
+    // portfolio: learned gates with at most share_size nodes or an LBD of at most share_lbd are
+    // published to the other solvers, whose gates are imported at level 0
+    bool share_learned{ true };
+    uint32_t share_size{ 8u };
+    uint32_t share_lbd{ 2u };
+};
+
+struct aig_dpll_stats {
+    uint64_t decisions{ 0u };
+    uint64_t propagations{ 0u };
+    uint64_t conflicts{ 0u };
+    uint64_t learned{ 0u };
+    uint64_t reductions{ 0u };
+    uint64_t removed{ 0u };
+    uint64_t restarts{ 0u };
+    uint64_t rephases{ 0u };
+    uint64_t minimized{ 0u };       // nodes removed from learned gates
+    uint64_t exported{ 0u };        // learned gates published to the other portfolio solvers
+    uint64_t imported{ 0u };        // learned gates of the other solvers that were not already satisfied
+    // seconds spent in conflict(): analysis, learning and backjumping
+    double conflict_time{ 0.0 };
+};
+
+// Exponential moving average, a plain average over the first 1 / alpha samples removes the bias of the start
+struct moving_average {
+    double alpha;
+    double value{ 0.0 };
+    uint64_t count{ 0u };
+
+    void update( double x )
+    {
+        ++count;
+        value += std::max( alpha, 1.0 / count ) * ( x - value );
+    }
+};
+
+// i-th element of the Luby sequence 1 1 2 1 1 2 4 1 1 2 ..., starting at i = 1
+inline uint64_t luby( uint64_t i )
+{
+    uint64_t size = 1u, power = 1u;
+    while ( size < i )
+    {
+        size = 2u * size + 1u;
+        power *= 2u;
+    }
+    while ( size != i )
+    {
+        size >>= 1;
+        power >>= 1;
+        if ( i > size )
+        {
+            i -= size;
+        }
+    }
+    return power;
+}
+
 // Class for solving AIG network
 class aig_dpll_solver
 {
   private:
-    // Reference to the AIG network
-    aig_ntk& m_ntk;
+    // Copy of the network with its fanouts, made when the one given has not built them
+    std::unique_ptr<aig_ntk> m_own_ntk;
+    // Reference to the AIG network, it is never modified by the solver
+    const aig_ntk& m_ntk;
+    aig_dpll_params m_ps;
+    aig_dpll_stats m_st;
 
-    // Node evaluation status and values
-    std::vector<bool> m_values;
-    std::vector<bool> m_assigned;
+    // Node values: VALUE_FALSE, VALUE_TRUE or VALUE_UNASSIGNED, one byte per node so that a
+    // check of a node against a value is a single load
+    std::vector<uint8_t> m_values;
     std::vector<GateId> trail_node;
+    // trail_node[qhead..] are assigned but their implications are not propagated yet
+    size_t qhead = 0;
     Direct_ImplicationTable di_table;
     Indirect_ImplicationTable ii_table;
-    std::unordered_map<GateId, Watch_Values> watch_vals;
-    std::unordered_map<GateId, std::vector<bool>> learn_watch_vals;
-    std::vector<float> m_activity;
-    std::vector<std::vector<GateId>> source;
+    // learned OR gates, and the ones watching a node for the value that falsifies their literal
+    learned_db m_learned;
+    Learned_WatchLists learn_watches;
+    // learned gate that caused the last conflict, if any
+    LearnedRef conf_learned = INVALID_LEARNED;
+    double learned_inc = 1.0;
+    uint64_t next_reduce = 0;
+    // restart schedule: conflicts since the last restart, limit of the counting policies, LBD averages
+    uint64_t restart_conflicts = 0;
+    uint64_t restart_limit = 0;
+    moving_average lbd_fast{ 0.0 };
+    moving_average lbd_slow{ 0.0 };
+    // per decision level stamps used to compute the LBD of learned gates
+    std::vector<uint64_t> level_stamp;
+    uint64_t stamp = 0;
+    // conflict activities of the nodes and the decision heap ordered by them
+    std::vector<double> m_activity;
+    activity_heap m_order{ m_activity };
+    double var_inc = 1.0;
+    // decision phases: initial, saved on backtrack, and the values of the longest conflict-free
+    // assignments since the last rephasing ( target ) and since the start ( best ). A node belongs
+    // to the target assignment if its stamp is target_epoch, the others take their saved phase.
+    std::vector<bool> init_phase;
+    std::vector<bool> saved_phase;
+    std::vector<bool> target_phase;
+    std::vector<bool> best_phase;
+    std::vector<uint32_t> target_stamp;
+    uint32_t target_epoch = 1;
+    size_t target_size = 0;
+    size_t best_size = 0;
+    uint64_t next_rephase = 0;
+    // Constraint that implied each node: ( gate << 2 ) | side for an AND gate,
+    // ( learned << 2 ) | LEARNED_REASON for a learned gate, NO_REASON for decisions.
+    // It is kept next to the decision level of the node, conflict analysis reads both.
+    struct AssignInfor {
+        uint32_t reason;
+        int level;
+    };
+    std::vector<AssignInfor> assign_info;
     std::vector<GateId> conf_lines;
-    std::vector<int> decision_level;
+    // conflict analysis: nodes already visited, the learned gate being built, and for its
+    // minimization the nodes marked on the way and the search stack
+    std::vector<bool> seen;
+    std::vector<GateId> learnt;
+    std::vector<GateId> to_clear;
+    std::vector<GateId> min_stack;
     int cur_level = 0;
-    uint32_t m_original_gate_size = 0;
-    uint64_t learning_gate_count = 0;
+
+    // J-frontier: AND gates assigned 0 whose fanins are all unassigned. Changes are recorded in
+    // j_log as ( gate << 1 ) | added and undone on backtrack, each frame only keeps the log size.
+    std::vector<GateId> j_nodes;
+    std::vector<uint32_t> j_index;
+    std::vector<uint32_t> j_log;
 
     struct DecInfor {
         size_t trail_start_index;
         uint32_t dec_line;
-        std::unordered_set<GateId> j_nodes;
+        size_t j_log_start;
     };
     std::vector<DecInfor> mdi;
 
+    // set by another thread to stop the search, e.g. when a portfolio member already answered
+    const std::atomic<bool>* m_stop = nullptr;
+    bool m_interrupted = false;
+    // learned gates shared with the other portfolio solvers, the id of this one and its read position
+    learned_exchange* m_exchange = nullptr;
+    uint32_t m_exchange_id = 0;
+    uint64_t m_import_cursor = 0;
+    std::vector<uint32_t> import_lits;
+
+    // incremental solving: assumptions of the current call, literals ( node << 1 ) | complement
+    // assumed to be 1, the ones that refuted the last call, and the conflict count when the call started
+    std::vector<uint32_t> m_assumptions;
+    std::vector<uint32_t> m_failed;
+    uint64_t m_call_conflicts = 0;
+
   public:
-    explicit aig_dpll_solver( aig_ntk& ntk )
-        : m_ntk( ntk ), m_values( ntk.get_gates().size(), false ), m_assigned( ntk.get_gates().size(), false )
+    static constexpr uint8_t VALUE_FALSE = 0u;
+    static constexpr uint8_t VALUE_TRUE = 1u;
+    static constexpr uint8_t VALUE_UNASSIGNED = 2u;
+    static constexpr uint32_t NO_REASON = NULL_INDEX;
+    static constexpr uint32_t LEARNED_REASON = 2u;
+
+    static uint32_t make_reason( GateId gate, bool side = false )
     {
+        return ( gate << 2 ) | ( side ? 1u : 0u );
+    }
 
-        ii_table[0].resize( m_ntk.get_gates().size() );
-        ii_table[1].resize( m_ntk.get_gates().size() );
-        m_ntk.build_implication_table( di_table, ii_table, watch_vals );
-        source.resize( m_ntk.get_gates().size() );
-        decision_level.resize( m_ntk.get_gates().size(), -1 );
+    static uint32_t make_learned_reason( LearnedRef ref )
+    {
+        return ( ref << 2 ) | LEARNED_REASON;
     }
 
-    void assign_node( GateId id, bool val, const std::vector<GateId>& from = {} )
+    explicit aig_dpll_solver( const aig_ntk& ntk, const aig_dpll_params& ps = {} )
+        : m_own_ntk( ntk.has_fanouts() ? nullptr : with_fanouts( ntk ) ), m_ntk( m_own_ntk ? *m_own_ntk : ntk ),
+          m_ps( ps ), m_values( ntk.num_nodes(), VALUE_UNASSIGNED )
     {
-        if ( m_assigned[id] )
+        next_reduce = m_ps.reduce_first;
+        lbd_fast.alpha = m_ps.restart_ema_fast;
+        lbd_slow.alpha = m_ps.restart_ema_slow;
+        restart_limit = next_restart_limit();
+        level_stamp.resize( m_ntk.num_nodes() + 1, 0u );
+        init_phase.assign( m_ntk.num_nodes(), false );
+        if ( m_ps.simulation_phase )
         {
-            return;
+            init_simulation_phases();
         }
+        saved_phase = init_phase;
+        if ( m_ps.phase == phase_policy::target )
+        {
+            target_phase = init_phase;
+            best_phase = init_phase;
+            target_stamp.assign( m_ntk.num_nodes(), 0u );
+            next_rephase = m_ps.rephase_interval;
+        }
+        if ( m_ps.decision == decision_strategy::vsids )
+        {
+            m_activity.assign( m_ntk.num_nodes(), 0.0 );
+            m_order.resize( m_ntk.num_nodes() );
+            for ( GateId id = 1; id < m_ntk.num_nodes(); ++id )
+            {
+                m_order.insert( id );
+            }
+        }
+
+        ii_table[0].resize( m_ntk.num_nodes() );
+        ii_table[1].resize( m_ntk.num_nodes() );
+        learn_watches[0].resize( m_ntk.num_nodes() );
+        learn_watches[1].resize( m_ntk.num_nodes() );
+        m_ntk.build_implication_table( di_table, ii_table );
+        assign_info.resize( m_ntk.num_nodes(), { NO_REASON, -1 } );
+        j_index.resize( m_ntk.num_nodes(), NULL_INDEX );
+        seen.resize( m_ntk.num_nodes(), false );
+    }
 
-        if ( id >= m_values.size() )
+    // Networks built in code may not have called build_fanouts(), the solver then works on a copy
+    static std::unique_ptr<aig_ntk> with_fanouts( const aig_ntk& ntk )
+    {
+        std::unique_ptr<aig_ntk> copy( new aig_ntk( ntk ) );
+        copy->build_fanouts();
+        return copy;
+    }
+
+    bool is_assigned( GateId id ) const
+    {
+        return m_values[id] != VALUE_UNASSIGNED;
+    }
+
+    // Whether id is assigned to val, false for unassigned nodes
+    bool has_value( GateId id, bool val ) const
+    {
+        return m_values[id] == static_cast<uint8_t>( val );
+    }
+
+    // Value of an assigned node
+    bool value( GateId id ) const
+    {
+        return m_values[id] == VALUE_TRUE;
+    }
+
+    void assign_node( GateId id, bool val, uint32_t from = NO_REASON )
+    {
+        if ( is_assigned( id ) )
         {
+            return;
         }
 
-        m_values[id] = val;
-        m_assigned[id] = true;
-        source[id] = from;
-        decision_level[id] = cur_level;
+        m_values[id] = static_cast<uint8_t>( val );
+        assign_info[id].reason = from;
+        assign_info[id].level = cur_level;
         trail_node.push_back( id );
 
-        if ( id > m_ntk.get_num_pis() && !val && all_inputs_unassigned( id ) )
+        // fanouts waiting for justification are no longer J-nodes once a fanin is assigned
+        for ( GateId out : m_ntk.get_fanouts( id ) )
         {
-
-            mdi.back().j_nodes.insert( id );
+            if ( j_index[out] != NULL_INDEX )
+            {
+                remove_jnode( out );
+                j_log.push_back( out << 1 );
+            }
+        }
+        if ( m_ntk.is_and( id ) && !val && all_inputs_unassigned( id ) )
+        {
+            insert_jnode( id );
+            j_log.push_back( ( id << 1 ) | 1u );
         }
     }
     bool all_inputs_unassigned( const GateId id )
     {
-        const auto& g = m_ntk.get_gates()[id];
-        for ( const auto& child : g.children )
+        for ( const auto& child : m_ntk.get_children( id ) )
         {
             GateId in_id = m_ntk.data_to_index( child );
-            if ( m_assigned[in_id] )
+            if ( is_assigned( in_id ) )
                 return false;
         }
         return true;
     }
-    void clean_jnodes( std::unordered_set<GateId>& jnodes )
+    void insert_jnode( GateId id )
+    {
+        j_index[id] = static_cast<uint32_t>( j_nodes.size() );
+        j_nodes.push_back( id );
+    }
+    void remove_jnode( GateId id )
+    {
+        GateId last = j_nodes.back();
+        j_nodes[j_index[id]] = last;
+        j_index[last] = j_index[id];
+        j_nodes.pop_back();
+        j_index[id] = NULL_INDEX;
+    }
+
+    // Undo the J-frontier changes recorded after position start of j_log, newest first
+    void undo_jnodes( size_t start )
     {
-        for ( auto it = jnodes.begin(); it != jnodes.end(); )
+        while ( j_log.size() > start )
         {
-            GateId id = *it;
-            bool output_is_zero = m_assigned[id] && ( m_values[id] == false );
-            bool inputs_unassigned = all_inputs_unassigned( id );
-            if ( !( output_is_zero && inputs_unassigned ) )
+            uint32_t entry = j_log.back();
+            j_log.pop_back();
+            if ( entry & 1u )
             {
-                it = jnodes.erase( it );
+                remove_jnode( entry >> 1 );
             }
             else
-                ++it;
+            {
+                insert_jnode( entry >> 1 );
+            }
         }
     }
 
@@ -110,16 +405,23 @@ class aig_dpll_solver
         mdi.clear();
         mdi.emplace_back();
         mdi.back().trail_start_index = trail_node.size();
+        mdi.back().j_log_start = j_log.size();
+        cur_level = 0;
 
+        // node 0 is the constant, outputs folded to it by structural hashing are only satisfiable if false
+        assign_node( 0, false );
         for ( auto out : m_ntk.get_outputs() )
         {
             GateId out_id = m_ntk.data_to_index( out );
             bool out_comp = m_ntk.data_to_complement( out );
             bool out_val = !out_comp;
-            cur_level = 0;
-            assign_node( out_id, out_val, {} );
+            if ( is_assigned( out_id ) && !has_value( out_id, out_val ) )
+            {
+                return false;
+            }
+            assign_node( out_id, out_val );
             mdi[0].dec_line = out_id;
-            if ( !BCP( out_id ) )
+            if ( !BCP() )
             {
                 return false;
             }
@@ -128,39 +430,122 @@ class aig_dpll_solver
         return true;
     }
 
+    // Most active unassigned node, assigned nodes left in the heap are dropped on the way
     GateId pick_unassigned_gate()
     {
-        GateId best = INVALID_GATE;
-        float max_activity = -1.0f;
-        for ( GateId id = 1; id < m_activity.size(); ++id )
+        while ( !m_order.empty() )
         {
-            if ( !m_assigned[id] && m_activity[id] > max_activity )
+            GateId id = m_order.pop();
+            if ( !is_assigned( id ) )
             {
-                max_activity = m_activity[id];
-                best = id;
+                return id;
             }
         }
-        return best;
+        return INVALID_GATE;
     }
-    GateId pick_from_j_node()
+
+    void bump_node( GateId id )
     {
-        if ( mdi.empty() )
-            return INVALID_GATE;
-        auto& jnodes = mdi.back().j_nodes;
-        if ( jnodes.empty() )
-            return INVALID_GATE;
+        if ( m_activity.empty() )
+        {
+            return;
+        }
+        m_activity[id] += var_inc;
+        if ( m_activity[id] > 1e100 )
+        {
+            for ( auto& a : m_activity )
+            {
+                a *= 1e-100;
+            }
+            var_inc *= 1e-100;
+        }
+        m_order.increase( id );
+    }
+
+    // Value given to a decision node
+    bool pick_phase( GateId id ) const
+    {
+        switch ( m_ps.phase )
+        {
+        case phase_policy::saved:
+            return saved_phase[id];
+        case phase_policy::target:
+            return target_stamp[id] == target_epoch ? target_phase[id] : saved_phase[id];
+        default:
+            return init_phase[id];
+        }
+    }
+
+    // Majority value of every node over simulation_words * 64 random input patterns
+    void init_simulation_phases()
+    {
+        aig_simulator sim( m_ntk, m_ps.simulation_words );
+        std::mt19937_64 rng( m_ps.seed );
+        sim.randomize_inputs( rng );
+        sim.simulate();
+        for ( GateId id = 1; id < m_ntk.num_nodes(); ++id )
+        {
+            init_phase[id] = 2u * sim.count_ones( id ) > sim.num_patterns();
+        }
+    }
+
+    // Remember the assignment below the conflict level if it is the longest conflict-free one so far
+    void update_target_phases()
+    {
+        size_t consistent = mdi.back().trail_start_index;
+        if ( consistent > target_size )
+        {
+            target_size = consistent;
+            ++target_epoch;
+            for ( size_t i = 0; i < consistent; ++i )
+            {
+                target_phase[trail_node[i]] = value( trail_node[i] );
+                target_stamp[trail_node[i]] = target_epoch;
+            }
+        }
+        if ( consistent > best_size )
+        {
+            best_size = consistent;
+            for ( size_t i = 0; i < consistent; ++i )
+            {
+                best_phase[trail_node[i]] = value( trail_node[i] );
+            }
+        }
+    }
 
+    // Empty the target assignment and reset the saved phases, cycling through best, initial, best
+    // and inverted initial phases
+    void rephase()
+    {
+        switch ( m_st.rephases++ % 4u )
+        {
+        case 1u:
+            saved_phase = init_phase;
+            break;
+        case 3u:
+            saved_phase = init_phase;
+            saved_phase.flip();
+            break;
+        default:
+            saved_phase = best_phase;
+            break;
+        }
+        ++target_epoch;
+        target_size = 0;
+        next_rephase = m_st.conflicts + m_ps.rephase_interval * ( m_st.rephases + 1 );
+    }
+    GateId pick_from_j_node()
+    {
         GateId best_gate = INVALID_GATE;
         size_t max_fanout = 0;
-        for ( GateId j : jnodes )
+        for ( GateId j : j_nodes )
         {
-            const auto& gate = m_ntk.get_gates()[j];
-            for ( auto child : gate.children )
+            for ( auto child : m_ntk.get_children( j ) )
             {
                 GateId in_id = m_ntk.data_to_index( child );
-                if ( m_assigned[in_id] )
+                if ( is_assigned( in_id ) )
                     continue;
-                size_t fanout = m_ntk.get_gates()[in_id].outputs.size();
+                size_t fanout = m_ntk.get_fanouts( in_id ).size();
 
                 if ( fanout > max_fanout )
                 {
@@ -172,391 +557,782 @@ class aig_dpll_solver
         return best_gate;
     }
 
-    bool BCP( GateId id )
+    // Propagate all pending assignments on the trail, returns false on conflict (conf_lines is filled)
+    bool BCP()
     {
+        while ( qhead < trail_node.size() )
+        {
+            m_st.propagations++;
+            if ( !propagate_node( trail_node[qhead++] ) )
+            {
+                qhead = trail_node.size();
+                return false;
+            }
+        }
+        return true;
+    }
 
-        bool val = m_values[id];
-        auto it = di_table.find( id );
-        if ( it != di_table.end() )
+    // Check the implications of a single assigned node, implied nodes are only enqueued on the trail
+    bool propagate_node( GateId id )
+    {
+        bool val = value( id );
+        for ( uint32_t edge : di_table.implications( id, val ) )
         {
-            for ( const auto& [next, next_val] : it->second[val] )
+            GateId next = Direct_ImplicationTable::edge_target( edge );
+            bool next_val = Direct_ImplicationTable::edge_value( edge );
+            if ( is_assigned( next ) )
             {
-                if ( next >= m_values.size() )
+                if ( !has_value( next, next_val ) )
                 {
+                    conf_lines.clear();
+                    conf_lines.push_back( id );
+                    conf_lines.push_back( next );
+                    return false;
                 }
-
-                if ( m_assigned[next] )
+            }
+            else
+            {
+                // fanins precede their fanouts, so next > id means id forced the AND gate next to 0
+                if ( next > id )
                 {
-                    if ( m_values[next] != next_val )
-                    {
-                        conf_lines.clear();
-                        std::unordered_set<GateId> in_conf;
-                        for ( auto g : source[id] )
-                        {
-                            if ( in_conf.insert( g ).second )
-                            {
-                                conf_lines.push_back( g );
-                            }
-                        }
-
-                        if ( in_conf.insert( next ).second )
-                        {
-                            conf_lines.push_back( next );
-                        }
-                        return false;
-                    }
+                    assign_node( next, next_val,
+                                 make_reason( next, m_ntk.data_to_index( m_ntk.get_children( next )[1] ) == id ) );
                 }
                 else
                 {
-                    std::vector<GateId> from = source[id];
-                    from.push_back( id );
-                    assign_node( next, next_val, from );
-                    if ( !BCP( next ) )
-                    {
-                        return false;
-                    }
+                    assign_node( next, next_val, make_reason( id ) );
                 }
             }
         }
 
         for ( const auto& out : ii_table[val][id] )
         {
-            if ( out < m_original_gate_size )
-            {
-                const auto& gate = m_ntk.get_gates()[out];
-                GateId left_node = m_ntk.data_to_index( gate.children[0] );
-                GateId right_node = m_ntk.data_to_index( gate.children[1] );
+            const auto& children = m_ntk.get_children( out );
+            GateId left_node = m_ntk.data_to_index( children[0] );
+            GateId right_node = m_ntk.data_to_index( children[1] );
 
-                bool left_wv = watch_vals[out].input1;
-                bool right_wv = watch_vals[out].input2;
-                bool out_wv = watch_vals[out].output;
+            bool left_wv = aig_ntk::watch_value( children[0] );
+            bool right_wv = aig_ntk::watch_value( children[1] );
 
-                bool left_match = false;
-                bool right_match = false;
-                bool out_match = false;
+            bool left_match = has_value( left_node, left_wv );
+            bool right_match = has_value( right_node, right_wv );
+            bool out_match = has_value( out, false );
+            int wv_count = left_match + right_match + out_match;
 
-                if ( m_assigned[left_node] && ( m_values[left_node] == watch_vals[out].input1 ) )
+            int assigned_count = is_assigned( left_node ) + is_assigned( right_node ) + is_assigned( out );
+
+            if ( assigned_count == 3 )
+            {
+                if ( wv_count == 3 )
                 {
-                    left_match = true;
+                    conf_lines.assign( { left_node, right_node, out } );
+                    return false;
                 }
-                if ( m_assigned[right_node] && ( m_values[right_node] == watch_vals[out].input2 ) )
+                if ( wv_count == 0 )
                 {
-                    right_match = true;
+                    // both fanins are 0 but the output is 1, one fanin is enough to explain it
+                    conf_lines.assign( { left_node, out } );
+                    return false;
                 }
-                if ( m_assigned[out] && ( m_values[out] == watch_vals[out].output ) )
+                if ( wv_count == 2 )
                 {
-                    out_match = true;
+                    continue;
                 }
-                int wv_count = left_match + right_match + out_match;
-
-                int assigned_count = m_assigned[left_node] + m_assigned[right_node] + m_assigned[out];
-
-                if ( assigned_count == 3 )
+                if ( wv_count == 1 )
                 {
-                    if ( ( wv_count == 3 ) || ( wv_count == 0 ) )
+                    if ( ( left_match ) || ( right_match ) )
                     {
-                        conf_lines.clear();
-                        std::unordered_set<GateId> in_conf;
-                        for ( GateId g : { left_node, right_node, out } )
-                        {
-                            if ( in_conf.insert( g ).second )
-                            {
-                                conf_lines.push_back( g );
-                            }
-                        }
+                        conf_lines.assign( { left_match ? right_node : left_node, out } );
                         return false;
                     }
-                    if ( wv_count == 2 )
+                    else
                     {
                         continue;
                     }
-                    if ( wv_count == 1 )
-                    {
-                        if ( ( left_match ) || ( right_match ) )
-                        {
-                            conf_lines.clear();
-                            std::unordered_set<GateId> in_conf;
-                            for ( GateId g : { left_node, right_node, out } )
-                            {
-                                if ( in_conf.insert( g ).second )
-                                {
-                                    conf_lines.push_back( g );
-                                }
-                            }
-                            return false;
-                        }
-                        else
-                        {
-                            continue;
-                        }
-                    }
                 }
+            }
+
+            if ( wv_count < assigned_count )
+            {
+                continue;
+            }
+
+            if ( assigned_count == 1 )
+            {
+                continue;
+            }
 
-                if ( wv_count < assigned_count )
+            if ( assigned_count == 2 )
+            {
+                if ( !is_assigned( left_node ) )
                 {
-                    continue;
+                    assign_node( left_node, !left_wv, make_reason( out ) );
                 }
-
-                if ( assigned_count == 1 )
+                if ( !is_assigned( right_node ) )
                 {
-                    continue;
+                    assign_node( right_node, !right_wv, make_reason( out ) );
                 }
-
-                if ( assigned_count == 2 )
+                if ( !is_assigned( out ) )
                 {
-                    if ( !m_assigned[left_node] )
-                    {
-                        std::vector<GateId> from;
-                        from.push_back( right_node );
-                        from.push_back( out );
-                        assign_node( left_node, !left_wv, from );
-                        if ( !BCP( left_node ) )
-                        {
-                            return false;
-                        }
-                    }
-                    if ( !m_assigned[right_node] )
-                    {
-                        std::vector<GateId> from;
-                        from.push_back( left_node );
-                        from.push_back( out );
-                        assign_node( right_node, !right_wv, from );
-                        if ( !BCP( right_node ) )
-                        {
-                            return false;
-                        }
-                    }
-                    if ( !m_assigned[out] )
-                    {
-                        std::vector<GateId> from;
-                        from.push_back( left_node );
-                        from.push_back( right_node );
-                        assign_node( out, true, from );
-                        if ( !BCP( out ) )
-                        {
-                            return false;
-                        }
-                    }
+                    assign_node( out, true, make_reason( out ) );
                 }
             }
-            else
+        }
+
+        return propagate_learned( id, val );
+    }
+
+    // Two-watched-literal propagation of the learned gates watching id, a watch is only moved
+    // when its literal becomes false
+    bool propagate_learned( GateId id, bool val )
+    {
+        auto& watchers = learn_watches[val][id];
+        size_t i = 0, j = 0;
+        while ( i < watchers.size() )
+        {
+            LearnedRef lg = watchers[i++];
+            uint32_t* lits = m_learned.lits( lg );
+            uint32_t k = m_learned.size( lg );
+
+            // keep the falsified watch in lits[1]
+            if ( ( lits[0] >> 1 ) == id )
             {
-                const auto& lg = m_ntk.get_gates()[out];
-                const auto& fanins = lg.fanins;
-                const auto& lwv_it = learn_watch_vals.find( out );
-                if ( lwv_it == learn_watch_vals.end() )
-                    continue;
+                std::swap( lits[0], lits[1] );
+            }
 
-                const std::vector<bool>& lwv = lwv_it->second;
-                size_t k = fanins.size();
-                size_t count_watch = 0;
-                size_t count_unassigned = 0;
-                GateId last_unassigned = INVALID_GATE;
+            // the gate is already satisfied by the other watch
+            GateId other = lits[0] >> 1;
+            if ( has_value( other, !( lits[0] & 1 ) ) )
+            {
+                watchers[j++] = lg;
+                continue;
+            }
 
-                for ( size_t i = 0; i < k; ++i )
+            // look for a literal that is not false to watch instead
+            bool moved = false;
+            for ( uint32_t l = 2; l < k; ++l )
+            {
+                GateId fin = lits[l] >> 1;
+                if ( !has_value( fin, lits[l] & 1 ) )
                 {
-                    GateId fin = fanins[i];
-                    if ( !m_assigned[fin] )
-                    {
-                        ++count_unassigned;
-                        last_unassigned = fin;
-                    }
-                    else
-                    {
-                        bool fin_val = m_values[fin];
-                        if ( fin_val == lwv[i] )
-                            ++count_watch;
-                    }
+                    std::swap( lits[1], lits[l] );
+                    learn_watches[lits[1] & 1][fin].push_back( lg );
+                    moved = true;
+                    break;
                 }
+            }
+            if ( moved )
+            {
+                continue;
+            }
 
-                if ( count_watch == k )
+            watchers[j++] = lg;
+            if ( is_assigned( other ) )
+            {
+                // all literals are false
+                conf_learned = lg;
+                conf_lines.clear();
+                for ( uint32_t l = 0; l < k; ++l )
                 {
-                    conf_lines.clear();
-                    std::unordered_set<GateId> in_conf;
-                    for ( GateId f : fanins )
-                    {
-                        if ( in_conf.insert( f ).second )
-                            conf_lines.push_back( f );
-                    }
-                    return false;
+                    conf_lines.push_back( lits[l] >> 1 );
                 }
-
-                // If exactly one unassigned and all others are watch => unit propagation
-                if ( count_unassigned == 1 && count_watch == k - 1 && last_unassigned != INVALID_GATE )
+                while ( i < watchers.size() )
                 {
-                    // find index of last_unassigned to get its wanted value (!watched)
-                    size_t idx = SIZE_MAX;
-                    for ( size_t i = 0; i < k; ++i )
-                    {
-                        if ( fanins[i] == last_unassigned )
-                        {
-                            idx = i;
-                            break;
-                        }
-                    }
-                    if ( idx == SIZE_MAX )
-                        continue; // shouldn't happen
-
-                    bool assign_val = !lwv[idx]; // non-watch value
-                    // build from vector: include other fanins and the learn_gate
-                    std::vector<GateId> from;
-                    for ( size_t i = 0; i < k; ++i )
-                    {
-                        if ( i == idx )
-                            continue;
-                        from.push_back( fanins[i] );
-                    }
-                    assign_node( last_unassigned, assign_val, from );
-                    if ( !BCP( last_unassigned ) )
-                        return false;
+                    watchers[j++] = watchers[i++];
                 }
+                watchers.resize( j );
+                return false;
             }
+
+            // unit: the remaining watch takes its non-watch value
+            assign_node( other, !( lits[0] & 1 ), make_learned_reason( lg ) );
         }
+        watchers.resize( j );
         return true;
     }
 
+    // Nodes whose assignments implied id, reconstructed from the gate stored in assign_info[id].reason
+    template <typename Fn> void foreach_antecedent( GateId id, Fn&& fn ) const
+    {
+        if ( ( assign_info[id].reason & 3u ) == LEARNED_REASON )
+        {
+            // learned OR gate: all other fanins are at their watch values
+            LearnedRef ref = assign_info[id].reason >> 2;
+            const uint32_t* lits = m_learned.lits( ref );
+            for ( uint32_t l = 0; l < m_learned.size( ref ); ++l )
+            {
+                if ( learned_db::lit_node( lits[l] ) != id )
+                {
+                    fn( learned_db::lit_node( lits[l] ) );
+                }
+            }
+            return;
+        }
+
+        GateId g = assign_info[id].reason >> 2;
+        const auto& children = m_ntk.get_children( g );
+        GateId left_node = m_ntk.data_to_index( children[0] );
+        GateId right_node = m_ntk.data_to_index( children[1] );
+        if ( id == g )
+        {
+            // output is 1 because both fanins are 1, or 0 because the fanin on the recorded side is 0
+            if ( value( id ) )
+            {
+                fn( left_node );
+                fn( right_node );
+            }
+            else
+            {
+                fn( ( assign_info[id].reason & 1 ) ? right_node : left_node );
+            }
+            return;
+        }
+
+        // fanin is forced by the output being 1, or by output 0 with the other fanin being 1
+        fn( g );
+        if ( !value( g ) )
+        {
+            fn( id == left_node ? right_node : left_node );
+        }
+    }
+
     void backtrack( int target_level )
     {
         if ( target_level >= cur_level )
             return;
         size_t keep_trail_index;
+        size_t keep_j_log;
         if ( target_level + 1 < (int)mdi.size() )
         {
             keep_trail_index = mdi[target_level + 1].trail_start_index;
+            keep_j_log = mdi[target_level + 1].j_log_start;
         }
         else
         {
             keep_trail_index = mdi[target_level].trail_start_index;
+            keep_j_log = mdi[target_level].j_log_start;
         }
+        undo_jnodes( keep_j_log );
         for ( int i = (int)trail_node.size() - 1; i >= (int)keep_trail_index; --i )
         {
             GateId n = trail_node[i];
-            m_assigned[n] = false;
-            decision_level[n] = -1;
-            source[n].clear();
+            saved_phase[n] = value( n );
+            m_values[n] = VALUE_UNASSIGNED;
+            assign_info[n].level = -1;
+            if ( !m_activity.empty() )
+            {
+                m_order.insert( n );
+            }
         }
         trail_node.resize( keep_trail_index );
+        qhead = std::min( qhead, keep_trail_index );
         mdi.resize( target_level + 1 );
         cur_level = target_level;
     }
 
-    bool conflict()
+    // Literal block distance: number of distinct decision levels among the nodes
+    template <typename It> uint32_t compute_lbd( It begin, It end )
     {
-
-        if ( conf_lines.empty() )
-            return false;
-
-        int num_at_cur_level = 0;
-        std::unordered_set<GateId> in_conf( conf_lines.begin(), conf_lines.end() );
-        int iteration = 0;
-        do
+        ++stamp;
+        uint32_t lbd = 0u;
+        for ( auto it = begin; it != end; ++it )
         {
-            iteration++;
-            conf_lines.erase( std::remove_if( conf_lines.begin(), conf_lines.end(),
-                                              [&]( GateId x ) { return decision_level[x] == 0; } ),
-                              conf_lines.end() );
-            if ( conf_lines.empty() )
+            int level = assign_info[*it].level;
+            if ( level_stamp[level] != stamp )
             {
-                return false;
+                level_stamp[level] = stamp;
+                ++lbd;
             }
+        }
+        return lbd;
+    }
 
-            num_at_cur_level = 0;
-            std::vector<GateId> expand_list;
-            for ( GateId g : conf_lines )
+    // compute_lbd over the nodes of the literals of a learned gate
+    uint32_t learned_lbd( LearnedRef ref )
+    {
+        ++stamp;
+        uint32_t lbd = 0u;
+        const uint32_t* lits = m_learned.lits( ref );
+        for ( uint32_t l = 0; l < m_learned.size( ref ); ++l )
+        {
+            int level = assign_info[learned_db::lit_node( lits[l] )].level;
+            if ( level_stamp[level] != stamp )
             {
-                if ( decision_level[g] == cur_level )
-                {
-                    num_at_cur_level++;
-                    if ( !source[g].empty() )
-                    {
-                        expand_list.push_back( g );
-                    }
-                }
+                level_stamp[level] = stamp;
+                ++lbd;
             }
-            if ( num_at_cur_level == 1 )
+        }
+        return lbd;
+    }
+
+    learned_tier tier_of( uint32_t lbd ) const
+    {
+        if ( lbd <= m_ps.glue_lbd )
+        {
+            return learned_tier::core;
+        }
+        return lbd <= m_ps.tier2_lbd ? learned_tier::tier2 : learned_tier::local;
+    }
+
+    // Bump a learned gate taking part in conflict analysis, and tighten its LBD
+    void bump_learned( LearnedRef ref )
+    {
+        auto& c = m_learned.info( ref );
+        c.used = true;
+        c.activity += static_cast<float>( learned_inc );
+        if ( c.activity > 1e20f )
+        {
+            for ( LearnedRef r = 0; r < m_learned.capacity(); ++r )
             {
-                break;
+                m_learned.info( r ).activity *= 1e-20f;
             }
-            if ( expand_list.empty() )
+            learned_inc *= 1e-20;
+        }
+
+        if ( c.tier != learned_tier::core )
+        {
+            uint32_t lbd = learned_lbd( ref );
+            if ( lbd < c.lbd )
             {
-                break;
+                c.lbd = lbd;
+                c.tier = std::min( c.tier, tier_of( lbd ) );
             }
-            for ( GateId g : expand_list )
-            {
-                in_conf.erase( g );
-                for ( GateId src : source[g] )
+        }
+    }
+
+    // A learned gate is locked while it is the reason of an assignment, the implied node is always lits[0]
+    bool is_locked( LearnedRef ref ) const
+    {
+        GateId n = learned_db::lit_node( m_learned.lits( ref )[0] );
+        return is_assigned( n ) && assign_info[n].reason == make_learned_reason( ref );
+    }
+
+    // Remove learned gates according to the reduce policy, called between decisions
+    void reduce_learned()
+    {
+        m_st.reductions++;
+        std::vector<LearnedRef> candidates;
+        for ( LearnedRef ref = 0; ref < m_learned.capacity(); ++ref )
+        {
+            auto& c = m_learned.info( ref );
+            if ( c.removed || c.size <= 2u || is_locked( ref ) )
+            {
+                continue;
+            }
+            bool used = c.used;
+            c.used = false;
+
+            switch ( m_ps.reduce )
+            {
+            case reduce_policy::none:
+                break;
+            case reduce_policy::activity:
+                candidates.push_back( ref );
+                break;
+            case reduce_policy::keep_glue:
+                if ( c.lbd > m_ps.glue_lbd )
                 {
-                    if ( in_conf.insert( src ).second )
-                    {
-                        conf_lines.push_back( src );
-                    }
+                    candidates.push_back( ref );
                 }
+                break;
+            case reduce_policy::tiered:
+                if ( c.tier == learned_tier::tier2 && !used )
+                {
+                    // not used since the last reduction, it competes with the local gates from now on
+                    c.tier = learned_tier::local;
+                }
+                else if ( c.tier == learned_tier::local )
+                {
+                    candidates.push_back( ref );
+                }
+                break;
             }
-            conf_lines.erase( std::remove_if( conf_lines.begin(), conf_lines.end(),
-                                              [&]( GateId x ) {
-                                                  return std::find( expand_list.begin(), expand_list.end(), x ) !=
-                                                         expand_list.end();
-                                              } ),
-                              conf_lines.end() );
+        }
 
-        } while ( true );
+        // remove the less useful half: higher LBD first for the tiered policy, lower activity otherwise
+        std::sort( candidates.begin(), candidates.end(), [&]( LearnedRef a, LearnedRef b ) {
+            const auto& ca = m_learned.info( a );
+            const auto& cb = m_learned.info( b );
+            if ( m_ps.reduce == reduce_policy::tiered && ca.lbd != cb.lbd )
+            {
+                return ca.lbd > cb.lbd;
+            }
+            return ca.activity < cb.activity;
+        } );
+        candidates.resize( candidates.size() / 2 );
+        for ( LearnedRef ref : candidates )
+        {
+            m_learned.remove( ref );
+        }
+        m_st.removed += candidates.size();
 
-        conf_lines.erase(
-            std::remove_if( conf_lines.begin(), conf_lines.end(), [&]( GateId x ) { return decision_level[x] == 0; } ),
-            conf_lines.end() );
-        if ( conf_lines.empty() )
+        // drop the watches of removed gates before their handles get reused
+        for ( auto& lists : learn_watches )
+        {
+            for ( auto& watchers : lists )
+            {
+                watchers.erase( std::remove_if( watchers.begin(), watchers.end(),
+                                                [&]( LearnedRef ref ) { return m_learned.info( ref ).removed; } ),
+                                watchers.end() );
+            }
+        }
+        m_learned.compact();
+    }
+
+    // Store the OR of the nodes differing from their current values, only the first two nodes are watched
+    LearnedRef add_learned_gate( const std::vector<GateId>& nodes )
+    {
+        std::vector<uint32_t> lits;
+        lits.reserve( nodes.size() );
+        for ( GateId g : nodes )
+        {
+            lits.push_back( learned_db::make_lit( g, value( g ) ) );
+        }
+        uint32_t lbd = compute_lbd( nodes.begin(), nodes.end() );
+        LearnedRef ref = m_learned.add( lits, lbd, tier_of( lbd ) );
+        m_learned.info( ref ).activity = static_cast<float>( learned_inc );
+        for ( size_t i = 0; i < std::min<size_t>( lits.size(), 2u ); ++i )
+        {
+            learn_watches[value( nodes[i] )][nodes[i]].push_back( ref );
+        }
+        return ref;
+    }
+
+    uint64_t next_restart_limit() const
+    {
+        switch ( m_ps.restart )
+        {
+        case restart_policy::luby:
+            return m_ps.restart_base * luby( m_st.restarts + 1 );
+        case restart_policy::geometric:
+            return static_cast<uint64_t>( m_ps.restart_base * std::pow( m_ps.restart_inc, m_st.restarts ) );
+        default:
+            return m_ps.restart_min_conflicts;
+        }
+    }
+
+    bool should_restart() const
+    {
+        if ( m_ps.restart == restart_policy::none || cur_level == 0 || restart_conflicts < restart_limit )
         {
             return false;
         }
-        if ( conf_lines.size() == 1 )
+        if ( m_ps.restart == restart_policy::glucose )
         {
-            GateId uip = conf_lines[0];
-            int uip_val = 1 - m_values[uip];
-            backtrack( 0 );
-            assign_node( uip, uip_val, {} );
-            conf_lines.clear();
-            if ( !BCP( uip ) )
+            return lbd_fast.value > m_ps.restart_margin * lbd_slow.value;
+        }
+        return true;
+    }
+
+    // Go back to level 0, learned gates and activities are kept
+    void restart()
+    {
+        backtrack( 0 );
+        m_st.restarts++;
+        restart_conflicts = 0;
+        restart_limit = next_restart_limit();
+    }
+
+    void update_restart_stats( uint32_t lbd )
+    {
+        restart_conflicts++;
+        lbd_fast.update( lbd );
+        lbd_slow.update( lbd );
+    }
+
+    // First-UIP analysis: walk the trail backwards and resolve the nodes of the conflict level with
+    // their antecedents until a single one is left. conf_lines becomes the learned gate with the
+    // asserting node first, returns false if the conflict does not depend on any decision.
+    bool analyze()
+    {
+        int conf_level = 0;
+        for ( GateId g : conf_lines )
+        {
+            conf_level = std::max( conf_level, assign_info[g].level );
+        }
+        if ( conf_level == 0 )
+        {
+            return false;
+        }
+        // BCP finds conflicts at the current level, this only guards the analysis below
+        backtrack( conf_level );
+
+        learnt.assign( 1u, INVALID_GATE );
+        uint32_t open = 0u; // seen nodes of the conflict level that are not resolved yet
+        auto visit = [&]( GateId n ) {
+            if ( seen[n] || assign_info[n].level == 0 )
             {
-                if ( !conflict() )
+                return;
+            }
+            seen[n] = true;
+            bump_node( n );
+            if ( assign_info[n].level == cur_level )
+            {
+                ++open;
+            }
+            else
+            {
+                learnt.push_back( n );
+            }
+        };
+        for ( GateId g : conf_lines )
+        {
+            visit( g );
+        }
+
+        size_t index = trail_node.size();
+        GateId uip = INVALID_GATE;
+        while ( true )
+        {
+            do
+            {
+                uip = trail_node[--index];
+            } while ( !seen[uip] );
+            seen[uip] = false;
+            if ( --open == 0u )
+            {
+                break;
+            }
+            if ( ( assign_info[uip].reason & 3u ) == LEARNED_REASON )
+            {
+                bump_learned( assign_info[uip].reason >> 2 );
+            }
+            foreach_antecedent( uip, visit );
+        }
+
+        learnt[0] = uip;
+        to_clear.assign( learnt.begin() + 1, learnt.end() );
+        if ( m_ps.minimize )
+        {
+            minimize_learnt();
+        }
+        for ( GateId n : to_clear )
+        {
+            seen[n] = false;
+        }
+        conf_lines.swap( learnt );
+        return true;
+    }
+
+    static uint32_t level_bit( int level )
+    {
+        return 1u << ( level & 31 );
+    }
+
+    // Drop the nodes of learnt[1..] whose assignments follow from the other nodes of the gate
+    void minimize_learnt()
+    {
+        uint32_t levels = 0u;
+        for ( size_t i = 1; i < learnt.size(); ++i )
+        {
+            levels |= level_bit( assign_info[learnt[i]].level );
+        }
+        size_t j = 1;
+        for ( size_t i = 1; i < learnt.size(); ++i )
+        {
+            if ( assign_info[learnt[i]].reason == NO_REASON || !is_redundant( learnt[i], levels ) )
+            {
+                learnt[j++] = learnt[i];
+            }
+        }
+        m_st.minimized += learnt.size() - j;
+        learnt.resize( j );
+    }
+
+    // Depth first search through the gate reasons of node: it is redundant if every path ends in a
+    // node of the learned gate. Only nodes on the decision levels of the gate are worth following,
+    // levels is a 32 bit abstraction of them. Nodes proven redundant stay marked in seen.
+    bool is_redundant( GateId node, uint32_t levels )
+    {
+        size_t top = to_clear.size();
+        min_stack.assign( 1u, node );
+        while ( !min_stack.empty() )
+        {
+            GateId n = min_stack.back();
+            min_stack.pop_back();
+            bool failed = false;
+            foreach_antecedent( n, [&]( GateId q ) {
+                if ( failed || seen[q] || assign_info[q].level == 0 )
                 {
-                    return false;
+                    return;
+                }
+                if ( assign_info[q].reason != NO_REASON && ( level_bit( assign_info[q].level ) & levels ) )
+                {
+                    seen[q] = true;
+                    min_stack.push_back( q );
+                    to_clear.push_back( q );
+                }
+                else
+                {
+                    failed = true;
+                }
+            } );
+            if ( failed )
+            {
+                for ( size_t i = top; i < to_clear.size(); ++i )
+                {
+                    seen[to_clear[i]] = false;
                 }
+                to_clear.resize( top );
+                return false;
             }
-            return true;
         }
+        return true;
+    }
+
+    // Learn from conf_lines, backjump and enqueue the asserting assignment, returns false if UNSAT
+    bool conflict()
+    {
+        auto start = std::chrono::steady_clock::now();
+        bool ok = learn_and_backjump();
+        m_st.conflict_time += std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+        return ok;
+    }
+
+    bool learn_and_backjump()
+    {
+        m_st.conflicts++;
+        if ( conf_learned != INVALID_LEARNED )
+        {
+            bump_learned( conf_learned );
+            conf_learned = INVALID_LEARNED;
+        }
+        learned_inc /= m_ps.learned_decay;
+        var_inc /= m_ps.var_decay;
 
-        std::vector<bool> learn_watch;
-        learn_watch.reserve( conf_lines.size() );
-        for ( const auto& g : conf_lines )
+        if ( conf_lines.empty() )
+            return false;
+        if ( m_ps.phase == phase_policy::target )
         {
-            learn_watch.push_back( m_values[g] == 1 );
+            update_target_phases();
         }
-        GateId learn_gate = m_ntk.create_or_learning_gate( conf_lines, learn_watch, ii_table, learn_watch_vals );
-        learning_gate_count++;
-        size_t new_size = m_ntk.get_gates().size();
-        if ( m_values.size() < new_size )
+        if ( !analyze() )
         {
-            m_values.resize( new_size, false );
-            m_assigned.resize( new_size, false );
-            decision_level.resize( new_size, -1 );
-            source.resize( new_size );
+            return false;
         }
-        m_assigned[learn_gate] = true;
-        m_values[learn_gate] = true;
-        decision_level[learn_gate] = 0;
-        source[learn_gate].clear();
 
-        std::sort( conf_lines.begin(), conf_lines.end(),
-                   [&]( GateId a, GateId b ) { return decision_level[a] > decision_level[b]; } );
         GateId uip = conf_lines[0];
-        GateId second = conf_lines[1];
-        int second_level = decision_level[second];
-        int uip_val = !m_values[uip];
-        backtrack( second_level );
-        std::vector<GateId> from( conf_lines.begin() + 1, conf_lines.end() );
-        assign_node( uip, uip_val, from );
+        bool uip_val = !value( uip );
+        if ( conf_lines.size() == 1 )
+        {
+            uint32_t lit = learned_db::make_lit( uip, value( uip ) );
+            export_learned( &lit, 1u, 1u );
+            update_restart_stats( 1u );
+            backtrack( 0 );
+            assign_node( uip, uip_val );
+            conf_lines.clear();
+            return true;
+        }
+
+        // the node of the backjump level becomes the second watch
+        auto second = std::max_element( conf_lines.begin() + 1, conf_lines.end(), [&]( GateId a, GateId b ) {
+            return assign_info[a].level < assign_info[b].level;
+        } );
+        std::iter_swap( conf_lines.begin() + 1, second );
+        LearnedRef learn_gate = add_learned_gate( conf_lines );
+        m_st.learned++;
+        update_restart_stats( m_learned.info( learn_gate ).lbd );
+        export_learned( m_learned.lits( learn_gate ), m_learned.size( learn_gate ), m_learned.info( learn_gate ).lbd );
+
+        backtrack( assign_info[conf_lines[1]].level );
+        assign_node( uip, uip_val, make_learned_reason( learn_gate ) );
         conf_lines.clear();
-        if ( !BCP( uip ) )
+        return true;
+    }
+
+    void export_learned( const uint32_t* lits, uint32_t size, uint32_t lbd )
+    {
+        if ( m_exchange != nullptr && ( size <= m_ps.share_size || lbd <= m_ps.share_lbd ) &&
+             m_exchange->publish( m_exchange_id, lits, size, lbd ) )
+        {
+            m_st.exported++;
+        }
+    }
+
+    // The assumption lit is refuted by the current assignment: collect in m_failed, with lit, the
+    // assumptions its node was implied from, by walking the trail backwards through the reasons.
+    // Decisions are all assumptions at this point.
+    void analyze_final( uint32_t lit )
+    {
+        m_failed.assign( 1u, lit );
+        GateId node = lit >> 1;
+        if ( assign_info[node].level <= 0 )
+        {
+            return;
+        }
+        seen[node] = true;
+        for ( size_t i = trail_node.size(); i-- > mdi[1].trail_start_index; )
+        {
+            GateId n = trail_node[i];
+            if ( !seen[n] )
+            {
+                continue;
+            }
+            seen[n] = false;
+            if ( assign_info[n].reason == NO_REASON )
+            {
+                m_failed.push_back( ( n << 1 ) | ( value( n ) ? 0u : 1u ) );
+            }
+            else
+            {
+                foreach_antecedent( n, [&]( GateId q ) {
+                    if ( assign_info[q].level > 0 )
+                    {
+                        seen[q] = true;
+                    }
+                } );
+            }
+        }
+    }
+
+    // Add the learned gates published by the other solvers since the last import. Called at level
+    // 0, where nodes fixed to their watch value are dropped and satisfied gates are skipped; a
+    // gate left with one node assigns it. Returns false if a gate is falsified, which proves UNSAT.
+    bool import_learned()
+    {
+        bool falsified = false;
+        m_exchange->collect( m_exchange_id, m_import_cursor, [&]( const uint32_t* lits, uint32_t size, uint32_t lbd ) {
+            if ( falsified )
+            {
+                return;
+            }
+            import_lits.clear();
+            for ( uint32_t i = 0; i < size; ++i )
+            {
+                GateId node = learned_db::lit_node( lits[i] );
+                if ( !is_assigned( node ) )
+                {
+                    import_lits.push_back( lits[i] );
+                }
+                else if ( !has_value( node, learned_db::lit_watch_value( lits[i] ) ) )
+                {
+                    return;
+                }
+            }
+            m_st.imported++;
+            if ( import_lits.empty() )
+            {
+                falsified = true;
+                return;
+            }
+            if ( import_lits.size() == 1u )
+            {
+                assign_node( learned_db::lit_node( import_lits[0] ), !learned_db::lit_watch_value( import_lits[0] ) );
+                return;
+            }
+            LearnedRef ref = m_learned.add( import_lits, lbd, tier_of( lbd ) );
+            m_learned.info( ref ).activity = static_cast<float>( learned_inc );
+            for ( size_t i = 0; i < 2u; ++i )
+            {
+                learn_watches[learned_db::lit_watch_value( import_lits[i] )][learned_db::lit_node( import_lits[i] )]
+                    .push_back( ref );
+            }
+        } );
+        if ( falsified )
+        {
+            return false;
+        }
+        while ( !BCP() )
         {
             if ( !conflict() )
             {
@@ -566,50 +1342,227 @@ class aig_dpll_solver
         return true;
     }
 
-    bool cdcl_search( std::vector<bool>& input_vals )
+    void extract_solution( std::vector<bool>& input_vals ) const
+    {
+        for ( GateId pi : m_ntk.get_inputs() )
+        {
+            // unassigned inputs are don't cares, they are set to 0
+            input_vals[pi - 1] = has_value( pi, true );
+        }
+    }
+
+    // Open a decision level and assign gate in it, the caller propagates
+    void new_decision( GateId gate, bool val )
     {
+        cur_level++;
+        DecInfor newframe;
+        newframe.dec_line = gate;
+        newframe.trail_start_index = trail_node.size();
+        newframe.j_log_start = j_log.size();
+        mdi.push_back( newframe );
+        assign_node( gate, val );
+    }
 
+    // Number of nodes assigned by deciding node = val and propagating, -1 on a conflict. The
+    // decision is undone before returning.
+    int64_t probe( GateId node, bool val )
+    {
+        size_t before = trail_node.size();
+        new_decision( node, val );
+        bool ok = BCP();
+        int64_t implied = static_cast<int64_t>( trail_node.size() - before );
         conf_lines.clear();
+        backtrack( cur_level - 1 );
+        return ok ? implied : -1;
+    }
 
-        while ( true )
+    // Lookahead candidates: unassigned fanins of the J-frontier, the ones with the largest
+    // fanout first, as pick_from_j_node chooses them
+    void lookahead_candidates( std::vector<GateId>& candidates, uint32_t max_candidates )
+    {
+        candidates.clear();
+        for ( GateId j : j_nodes )
         {
-            clean_jnodes( mdi.back().j_nodes );
+            for ( auto child : m_ntk.get_children( j ) )
+            {
+                GateId in_id = m_ntk.data_to_index( child );
+                if ( !is_assigned( in_id ) && !seen[in_id] )
+                {
+                    seen[in_id] = true;
+                    candidates.push_back( in_id );
+                }
+            }
+        }
+        for ( GateId c : candidates )
+        {
+            seen[c] = false;
+        }
+        auto fanout_order = [&]( GateId a, GateId b ) {
+            return m_ntk.get_fanouts( a ).size() > m_ntk.get_fanouts( b ).size();
+        };
+        if ( candidates.size() > max_candidates )
+        {
+            std::partial_sort( candidates.begin(), candidates.begin() + max_candidates, candidates.end(),
+                               fanout_order );
+            candidates.resize( max_candidates );
+        }
+    }
 
-            if ( mdi.back().j_nodes.empty() )
+    // Split the search space below the current assignment into cubes of at most depth decisions.
+    // Both values of each candidate are probed; a value that fails is a failed literal and the
+    // other one is assigned in the current level, otherwise the candidate scores the product of
+    // the nodes both values imply and the best one is branched on. Refuted branches yield no cube.
+    // Returns true, with solution filled, if a satisfying assignment is met on the way.
+    bool split( uint32_t depth, uint32_t num_candidates, std::vector<uint32_t>& cube,
+                std::vector<std::vector<uint32_t>>& cubes, std::vector<bool>& solution )
+    {
+        std::vector<GateId> candidates;
+        GateId best = INVALID_GATE;
+        while ( best == INVALID_GATE )
+        {
+            if ( j_nodes.empty() )
+            {
+                extract_solution( solution );
+                return true;
+            }
+            if ( depth == 0u )
+            {
+                cubes.push_back( cube );
+                return false;
+            }
+            lookahead_candidates( candidates, num_candidates );
+            uint64_t best_score = 0u;
+            bool failed = false;
+            for ( GateId node : candidates )
             {
-                for ( GateId pi : m_ntk.get_inputs() )
+                if ( is_assigned( node ) )
                 {
-                    if ( m_assigned[pi] )
+                    continue;
+                }
+                int64_t implied0 = probe( node, false );
+                int64_t implied1 = probe( node, true );
+                if ( implied0 < 0 || implied1 < 0 )
+                {
+                    if ( implied0 < 0 && implied1 < 0 )
                     {
-                        input_vals[pi - 1] = m_values[pi];
+                        return false;
                     }
-                    else
+                    assign_node( node, implied0 < 0 );
+                    if ( !BCP() )
+                    {
+                        conf_lines.clear();
+                        return false;
+                    }
+                    failed = true;
+                    continue;
+                }
+                uint64_t score = static_cast<uint64_t>( implied0 + 1 ) * static_cast<uint64_t>( implied1 + 1 );
+                if ( score > best_score )
+                {
+                    best_score = score;
+                    best = node;
+                }
+            }
+            // failed literals changed the frontier, the scores are outdated
+            if ( failed )
+            {
+                best = INVALID_GATE;
+            }
+        }
+
+        for ( bool val : { false, true } )
+        {
+            new_decision( best, val );
+            bool sat = false;
+            if ( BCP() )
+            {
+                cube.push_back( ( best << 1 ) | ( val ? 0u : 1u ) );
+                sat = split( depth - 1u, num_candidates, cube, cubes, solution );
+                cube.pop_back();
+            }
+            conf_lines.clear();
+            backtrack( cur_level - 1 );
+            if ( sat )
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool cdcl_search( std::vector<bool>& input_vals )
+    {
+
+        conf_lines.clear();
+
+        while ( true )
+        {
+            if ( ( m_stop != nullptr && m_stop->load( std::memory_order_relaxed ) ) ||
+                 ( m_ps.conflict_limit != 0u && m_st.conflicts - m_call_conflicts >= m_ps.conflict_limit ) )
+            {
+                m_interrupted = true;
+                return false;
+            }
+            if ( m_ps.reduce != reduce_policy::none && m_st.conflicts >= next_reduce )
+            {
+                reduce_learned();
+                next_reduce = m_st.conflicts + m_ps.reduce_first + m_ps.reduce_inc * m_st.reductions;
+            }
+            if ( should_restart() )
+            {
+                restart();
+            }
+            if ( m_ps.phase == phase_policy::target && m_st.conflicts >= next_rephase )
+            {
+                rephase();
+            }
+            if ( cur_level == 0 && m_exchange != nullptr && m_exchange->tail() != m_import_cursor && !import_learned() )
+            {
+                return false;
+            }
+
+            // assumption i is the decision of level i + 1, it is made again after every backjump below it
+            if ( cur_level < static_cast<int>( m_assumptions.size() ) )
+            {
+                uint32_t lit = m_assumptions[cur_level];
+                GateId node = aig_ntk::data_to_index( lit );
+                bool val = !aig_ntk::data_to_complement( lit );
+                if ( is_assigned( node ) && !has_value( node, val ) )
+                {
+                    analyze_final( lit );
+                    return false;
+                }
+                // a node that already has the value gets an empty level
+                new_decision( node, val );
+                while ( !BCP() )
+                {
+                    if ( !conflict() )
                     {
-                        input_vals[pi - 1] = 0;
+                        return false;
                     }
                 }
+                continue;
+            }
+
+            if ( j_nodes.empty() )
+            {
+                extract_solution( input_vals );
                 return true;
             }
 
-            GateId gate = pick_from_j_node();
+            GateId gate = m_ps.decision == decision_strategy::vsids ? pick_unassigned_gate() : pick_from_j_node();
             if ( gate == INVALID_GATE )
             {
                 return false;
             }
-            cur_level++;
-            DecInfor newframe;
-            newframe.dec_line = gate;
-            newframe.trail_start_index = trail_node.size();
-            newframe.j_nodes = mdi.back().j_nodes;
-            auto saved_jnodes = newframe.j_nodes;
-            mdi.push_back( std::move( newframe ) );
-            assign_node( gate, false, {} );
+            m_st.decisions++;
+            new_decision( gate, pick_phase( gate ) );
 
-            if ( !BCP( gate ) )
+            // every conflict backjumps and enqueues the asserting assignment, keep propagating until stable
+            while ( !BCP() )
             {
                 if ( !conflict() )
                 {
-
                     return false;
                 }
             }
@@ -620,8 +1573,6 @@ class aig_dpll_solver
     bool solve( std::vector<bool>& solution )
     {
         // std::cout<<"input_num is "<<m_ntk.get_num_pis()<<std::endl;
-        m_original_gate_size = m_ntk.get_gates().size();
-        // std::cout << "[DEBUG] Original gate count: " << m_original_gate_size << "\n";
         solution.resize( m_ntk.get_inputs().size() );
         // print_implication_tables(di_table, ii_table);
         if ( !po_first() )
@@ -631,22 +1582,160 @@ class aig_dpll_solver
         }
         return cdcl_search( solution );
     }
+
+    // Incremental solving: is there an assignment of the network satisfying the assumptions, each a literal
+    // ( node << 1 ) | complement on any node, as in get_outputs(), that is assumed to be 1. The outputs are not
+    // asserted, assume them to ask for them. Learned gates, activities, phases and implication tables are kept from
+    // one call to the next, since every learned gate follows from the network alone. On UNSAT failed_assumptions()
+    // gives the assumptions that were found contradictory. Not to be mixed with the other solve functions or
+    // lookahead, which assert the outputs for good.
+    bool solve( std::vector<bool>& solution, const std::vector<uint32_t>& assumptions )
+    {
+        solution.resize( m_ntk.get_inputs().size() );
+        m_interrupted = false;
+        m_failed.clear();
+        if ( mdi.empty() )
+        {
+            mdi.emplace_back();
+            mdi.back().trail_start_index = trail_node.size();
+            mdi.back().dec_line = 0;
+            mdi.back().j_log_start = j_log.size();
+            assign_node( 0, false );
+        }
+        m_assumptions = assumptions;
+        // every assumption opens a level, even a repeated or implied one
+        level_stamp.resize( std::max( level_stamp.size(), m_ntk.num_nodes() + 1 + m_assumptions.size() ), 0u );
+        m_call_conflicts = m_st.conflicts;
+        bool is_sat = BCP() && cdcl_search( solution );
+        backtrack( 0 );
+        return is_sat;
+    }
+
+    // Subset of the assumptions of the last incremental solve that has no solution, empty if
+    // it was SAT or interrupted
+    const std::vector<uint32_t>& failed_assumptions() const
+    {
+        return m_failed;
+    }
+
+    // Make solve give up, returning false with interrupted() set, once *stop becomes true. The
+    // flag is polled before every decision, as the conflict limit is.
+    void set_stop_flag( const std::atomic<bool>* stop )
+    {
+        m_stop = stop;
+    }
+
+    bool interrupted() const
+    {
+        return m_interrupted;
+    }
+
+    // Status of a solve call that returned is_sat
+    sat_status status( bool is_sat ) const
+    {
+        return is_sat ? sat_status::sat : m_interrupted ? sat_status::unknown : sat_status::unsat;
+    }
+
+    // Share learned gates through exchange, as the solver with the given id, when share_learned is set
+    void set_exchange( learned_exchange* exchange, uint32_t id )
+    {
+        m_exchange = m_ps.share_learned ? exchange : nullptr;
+        m_exchange_id = id;
+    }
+
+    // Cube generation: split the problem by lookahead into cubes of at most depth decisions,
+    // each one a list of literals ( node << 1 ) | complement that hold in it. Unless a satisfying
+    // assignment is found on the way, in which case true is returned with solution filled, the
+    // problem is SAT if and only if one of the cubes is; no cube at all means UNSAT.
+    bool lookahead( uint32_t depth, uint32_t num_candidates, std::vector<std::vector<uint32_t>>& cubes,
+                    std::vector<bool>& solution )
+    {
+        solution.resize( m_ntk.get_inputs().size() );
+        if ( !po_first() )
+        {
+            return false;
+        }
+        std::vector<uint32_t> cube;
+        return split( depth, num_candidates, cube, cubes, solution );
+    }
+
+    // Solve under a cube of literals ( node << 1 ) | complement assumed to be 1, as in solve( solution,
+    // assumptions ). They become level 0 facts, so the solver must not be used for anything else afterwards.
+    bool solve_cube( std::vector<bool>& solution, const std::vector<uint32_t>& cube )
+    {
+        solution.resize( m_ntk.get_inputs().size() );
+        if ( !po_first() )
+        {
+            return false;
+        }
+        for ( uint32_t lit : cube )
+        {
+            GateId node = aig_ntk::data_to_index( lit );
+            bool val = !aig_ntk::data_to_complement( lit );
+            if ( is_assigned( node ) )
+            {
+                if ( !has_value( node, val ) )
+                {
+                    return false;
+                }
+                continue;
+            }
+            assign_node( node, val );
+            if ( !BCP() )
+            {
+                conf_lines.clear();
+                return false;
+            }
+        }
+        return cdcl_search( solution );
+    }
+
+    const aig_dpll_stats& stats() const
+    {
+        return m_st;
+    }
+
+    const learned_db& learned() const
+    {
+        return m_learned;
+    }
 };
 
-inline std::pair<bool, std::optional<std::vector<bool>>> solve_aig( aig_ntk& ntk )
+// Words per block of the SAT fast path, fewer than ps.sat_simulation_words on networks so large
+// that the signatures would take more than 2^23 words, 64 MB
+inline uint32_t simulation_words( const aig_ntk& ntk, const aig_dpll_params& ps )
+{
+    constexpr uint64_t max_words = uint64_t( 1u ) << 23;
+    uint64_t words = std::min<uint64_t>( ps.sat_simulation_words, max_words / std::max( 1u, ntk.num_nodes() ) );
+    return static_cast<uint32_t>( std::max<uint64_t>( 1u, words ) );
+}
+
+// SAT fast path run once by the drivers before they build any solver, see sat_simulation_rounds
+inline bool simulate_first( const aig_ntk& ntk, const aig_dpll_params& ps, std::vector<bool>& solution )
+{
+    return ps.sat_simulation_rounds > 0u &&
+           simulate_for_solution( ntk, simulation_words( ntk, ps ), ps.sat_simulation_rounds, ps.seed, solution );
+}
+
+inline solve_result solve_aig( const aig_ntk& ntk, const aig_dpll_params& ps = {} )
 {
-    aig_dpll_solver solver( ntk );
     std::vector<bool> solution;
+    if ( simulate_first( ntk, ps, solution ) )
+    {
+        return { sat_status::sat, std::move( solution ) };
+    }
+
+    aig_dpll_solver solver( ntk, ps );
 
     bool is_sat = solver.solve( solution );
 
     if ( is_sat )
     {
-        return { true, std::move( solution ) };
+        return { sat_status::sat, std::move( solution ) };
     }
     else
     {
-        return { false, std::nullopt };
+        return { solver.status( false ), std::nullopt };
     }
 }
 
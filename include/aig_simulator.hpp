@@ -0,0 +1,249 @@
+/**
+ * @file aig_simulator.hpp
+ * @brief Bit-parallel random simulation of aig_ntk
+ * @copyright Copyright (c) 2023- Zhufei Chu, Ningbo University. MIT License.
+ */
+
+#ifndef CIRSAT_AIG_SIMULATOR_HPP
+#define CIRSAT_AIG_SIMULATOR_HPP
+
+#include "aig.hpp"
+#include <bitset>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#if defined( __AVX2__ ) || defined( __AVX512F__ )
+#include <immintrin.h>
+#endif
+
+namespace cirsat {
+
+// Simulates 64 * num_words input patterns at once. The signatures are kept in one contiguous
+// node x word matrix, row n holding the values of node n under every pattern, and the AND
+// gates are evaluated in index order, which is topological. Rows are combined with AVX-512 or
+// AVX2 when the compiler targets them, 64-bit words otherwise.
+class aig_simulator
+{
+  public:
+    aig_simulator( const aig_ntk& ntk, uint32_t num_words )
+        : m_ntk( ntk ), m_num_words( num_words ), m_sigs( static_cast<size_t>( ntk.num_nodes() ) * num_words, 0u )
+    {
+    }
+
+    uint32_t num_words() const
+    {
+        return m_num_words;
+    }
+
+    uint64_t num_patterns() const
+    {
+        return 64u * static_cast<uint64_t>( m_num_words );
+    }
+
+    uint64_t* signature( GateId id )
+    {
+        return m_sigs.data() + static_cast<size_t>( id ) * m_num_words;
+    }
+    const uint64_t* signature( GateId id ) const
+    {
+        return m_sigs.data() + static_cast<size_t>( id ) * m_num_words;
+    }
+
+    // Fill the input rows with random patterns, word by word and input by input
+    void randomize_inputs( std::mt19937_64& rng )
+    {
+        const auto& inputs = m_ntk.get_inputs();
+        for ( uint32_t w = 0; w < m_num_words; ++w )
+        {
+            for ( GateId pi : inputs )
+            {
+                signature( pi )[w] = rng();
+            }
+        }
+    }
+
+    // Evaluate every AND gate from the current input rows
+    void simulate()
+    {
+        const GateId num_nodes = m_ntk.num_nodes();
+        for ( GateId id = 1; id < num_nodes; ++id )
+        {
+            if ( m_ntk.is_and( id ) )
+            {
+                const auto& children = m_ntk.get_children( id );
+                and_rows( signature( id ), signature( aig_ntk::data_to_index( children[0] ) ),
+                          aig_ntk::data_to_complement( children[0] ), signature( aig_ntk::data_to_index( children[1] ) ),
+                          aig_ntk::data_to_complement( children[1] ) );
+            }
+        }
+    }
+
+    // Index of a pattern under which every output is 1, or -1 if there is none
+    int64_t find_satisfying_pattern() const
+    {
+        for ( uint32_t w = 0; w < m_num_words; ++w )
+        {
+            uint64_t word = ~uint64_t( 0u );
+            for ( uint32_t out : m_ntk.get_outputs() )
+            {
+                uint64_t value = signature( aig_ntk::data_to_index( out ) )[w];
+                word &= aig_ntk::data_to_complement( out ) ? ~value : value;
+                if ( word == 0u )
+                {
+                    break;
+                }
+            }
+            if ( word != 0u )
+            {
+                return 64 * static_cast<int64_t>( w ) + lowest_bit( word );
+            }
+        }
+        return -1;
+    }
+
+    // Index of a pattern under which the literal lit is 1, or -1 if there is none
+    int64_t find_pattern( uint32_t lit ) const
+    {
+        const uint64_t flip = aig_ntk::data_to_complement( lit ) ? ~uint64_t( 0u ) : 0u;
+        const uint64_t* row = signature( aig_ntk::data_to_index( lit ) );
+        for ( uint32_t w = 0; w < m_num_words; ++w )
+        {
+            uint64_t word = row[w] ^ flip;
+            if ( word != 0u )
+            {
+                return 64 * static_cast<int64_t>( w ) + lowest_bit( word );
+            }
+        }
+        return -1;
+    }
+
+    bool value( GateId id, uint64_t pattern ) const
+    {
+        return ( signature( id )[pattern >> 6] >> ( pattern & 63u ) ) & 1u;
+    }
+
+    // Input values of a pattern, in the order of the primary inputs
+    void input_pattern( uint64_t pattern, std::vector<bool>& inputs ) const
+    {
+        const auto& pis = m_ntk.get_inputs();
+        inputs.resize( pis.size() );
+        for ( size_t i = 0; i < pis.size(); ++i )
+        {
+            inputs[i] = value( pis[i], pattern );
+        }
+    }
+
+    // Number of patterns under which the node is 1
+    uint64_t count_ones( GateId id ) const
+    {
+        uint64_t ones = 0u;
+        const uint64_t* row = signature( id );
+        for ( uint32_t w = 0; w < m_num_words; ++w )
+        {
+            ones += std::bitset<64>( row[w] ).count();
+        }
+        return ones;
+    }
+
+  private:
+    static uint32_t lowest_bit( uint64_t word )
+    {
+        uint32_t bit = 0u;
+        while ( !( ( word >> bit ) & 1u ) )
+        {
+            ++bit;
+        }
+        return bit;
+    }
+
+    void and_rows( uint64_t* out, const uint64_t* a, bool a_comp, const uint64_t* b, bool b_comp ) const
+    {
+        const uint64_t a_mask = a_comp ? ~uint64_t( 0u ) : 0u;
+        const uint64_t b_mask = b_comp ? ~uint64_t( 0u ) : 0u;
+        uint32_t w = 0u;
+#if defined( __AVX512F__ )
+        const __m512i a_mask512 = _mm512_set1_epi64( static_cast<long long>( a_mask ) );
+        const __m512i b_mask512 = _mm512_set1_epi64( static_cast<long long>( b_mask ) );
+        for ( ; w + 8u <= m_num_words; w += 8u )
+        {
+            __m512i x = _mm512_xor_si512( _mm512_loadu_si512( a + w ), a_mask512 );
+            __m512i y = _mm512_xor_si512( _mm512_loadu_si512( b + w ), b_mask512 );
+            _mm512_storeu_si512( out + w, _mm512_and_si512( x, y ) );
+        }
+#endif
+#if defined( __AVX2__ )
+        const __m256i a_mask256 = _mm256_set1_epi64x( static_cast<long long>( a_mask ) );
+        const __m256i b_mask256 = _mm256_set1_epi64x( static_cast<long long>( b_mask ) );
+        for ( ; w + 4u <= m_num_words; w += 4u )
+        {
+            __m256i x = _mm256_xor_si256( _mm256_loadu_si256( reinterpret_cast<const __m256i*>( a + w ) ), a_mask256 );
+            __m256i y = _mm256_xor_si256( _mm256_loadu_si256( reinterpret_cast<const __m256i*>( b + w ) ), b_mask256 );
+            _mm256_storeu_si256( reinterpret_cast<__m256i*>( out + w ), _mm256_and_si256( x, y ) );
+        }
+#endif
+        for ( ; w < m_num_words; ++w )
+        {
+            out[w] = ( a[w] ^ a_mask ) & ( b[w] ^ b_mask );
+        }
+    }
+
+  private:
+    const aig_ntk& m_ntk;
+    uint32_t m_num_words;
+    std::vector<uint64_t> m_sigs;
+};
+
+// SAT fast path: simulate num_rounds blocks of random patterns and look for one that sets every
+// output to 1. Returns true with the input values in solution when it finds one.
+inline bool simulate_for_solution( const aig_ntk& ntk, uint32_t num_words, uint32_t num_rounds, uint64_t seed,
+                                   std::vector<bool>& solution )
+{
+    if ( ntk.get_outputs().empty() || num_words == 0u )
+    {
+        return false;
+    }
+    aig_simulator sim( ntk, num_words );
+    std::mt19937_64 rng( seed );
+    for ( uint32_t round = 0; round < num_rounds; ++round )
+    {
+        sim.randomize_inputs( rng );
+        sim.simulate();
+        int64_t pattern = sim.find_satisfying_pattern();
+        if ( pattern >= 0 )
+        {
+            sim.input_pattern( static_cast<uint64_t>( pattern ), solution );
+            return true;
+        }
+    }
+    return false;
+}
+
+// Whether the input values of solution, one per primary input, set every output to 1. They are
+// simulated as the first pattern of a single word.
+inline bool check_solution( const aig_ntk& ntk, const std::vector<bool>& solution )
+{
+    const auto& inputs = ntk.get_inputs();
+    if ( solution.size() != inputs.size() )
+    {
+        return false;
+    }
+    aig_simulator sim( ntk, 1u );
+    for ( size_t i = 0; i < inputs.size(); ++i )
+    {
+        sim.signature( inputs[i] )[0] = solution[i] ? 1u : 0u;
+    }
+    sim.simulate();
+    for ( uint32_t out : ntk.get_outputs() )
+    {
+        if ( sim.value( aig_ntk::data_to_index( out ), 0u ) == aig_ntk::data_to_complement( out ) )
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace cirsat
+
+#endif // CIRSAT_AIG_SIMULATOR_HPP
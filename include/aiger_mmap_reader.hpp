@@ -0,0 +1,282 @@
+/**
+ * @file aiger_mmap_reader.hpp
+ * @brief Zero-copy parser of binary AIGER files mapped into memory
+ * @copyright Copyright (c) 2023- Zhufei Chu, Ningbo University. MIT License.
+ */
+
+#ifndef CIRSAT_AIGER_MMAP_READER_HPP
+#define CIRSAT_AIGER_MMAP_READER_HPP
+
+#include "aig.hpp"
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#if defined( _WIN32 )
+#include <fstream>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace cirsat {
+
+// Read-only view of a whole file, mapped into memory where mmap is available and read into a
+// buffer otherwise
+class mapped_file
+{
+  public:
+    explicit mapped_file( const std::string& filename )
+    {
+#if defined( _WIN32 )
+        std::ifstream file( filename, std::ios::binary | std::ios::ate );
+        if ( !file.is_open() )
+        {
+            return;
+        }
+        m_buffer.resize( static_cast<size_t>( file.tellg() ) );
+        file.seekg( 0 );
+        file.read( m_buffer.data(), m_buffer.size() );
+        m_data = m_buffer.data();
+        m_size = m_buffer.size();
+        m_open = static_cast<bool>( file );
+#else
+        int fd = ::open( filename.c_str(), O_RDONLY );
+        if ( fd < 0 )
+        {
+            return;
+        }
+        struct stat st;
+        if ( ::fstat( fd, &st ) == 0 )
+        {
+            m_size = static_cast<size_t>( st.st_size );
+            if ( m_size == 0u )
+            {
+                m_open = true;
+            }
+            else
+            {
+                void* addr = ::mmap( nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0 );
+                if ( addr != MAP_FAILED )
+                {
+                    ::madvise( addr, m_size, MADV_SEQUENTIAL );
+                    m_data = static_cast<const char*>( addr );
+                    m_open = true;
+                }
+            }
+        }
+        ::close( fd );
+#endif
+    }
+
+    ~mapped_file()
+    {
+#if !defined( _WIN32 )
+        if ( m_data != nullptr )
+        {
+            ::munmap( const_cast<char*>( m_data ), m_size );
+        }
+#endif
+    }
+
+    mapped_file( const mapped_file& ) = delete;
+    mapped_file& operator=( const mapped_file& ) = delete;
+
+    bool is_open() const
+    {
+        return m_open;
+    }
+    const char* data() const
+    {
+        return m_data;
+    }
+    size_t size() const
+    {
+        return m_size;
+    }
+
+  private:
+    const char* m_data{ nullptr };
+    size_t m_size{ 0u };
+    bool m_open{ false };
+#if defined( _WIN32 )
+    std::vector<char> m_buffer;
+#endif
+};
+
+inline bool is_binary_aiger( const char* data, size_t size )
+{
+    return size >= 4u && std::memcmp( data, "aig ", 4u ) == 0;
+}
+
+namespace detail {
+
+// Cursor over the bytes of a binary AIGER file, every read checks the end of the buffer
+struct aiger_cursor {
+    const char* pos;
+    const char* end;
+
+    bool read_number( uint64_t& value )
+    {
+        if ( pos == end || *pos < '0' || *pos > '9' )
+        {
+            return false;
+        }
+        value = 0u;
+        while ( pos != end && *pos >= '0' && *pos <= '9' )
+        {
+            value = value * 10u + static_cast<uint64_t>( *pos++ - '0' );
+        }
+        return true;
+    }
+
+    bool skip( char c )
+    {
+        if ( pos == end || *pos != c )
+        {
+            return false;
+        }
+        ++pos;
+        return true;
+    }
+
+    // Unsigned LEB128 delta of an AND gate, at most 32 bits
+    bool read_delta( uint32_t& delta )
+    {
+        delta = 0u;
+        for ( unsigned shift = 0u; shift < 35u; shift += 7u )
+        {
+            if ( pos == end )
+            {
+                return false;
+            }
+            uint8_t ch = static_cast<uint8_t>( *pos++ );
+            delta |= static_cast<uint32_t>( ch & 0x7fu ) << shift;
+            if ( !( ch & 0x80u ) )
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+};
+
+} // namespace detail
+
+// Build ntk from a binary AIGER file in memory. The AND gates are decoded straight from the
+// delta stream into the pre-reserved arrays of ntk, which must be empty; its structural hashing
+// mode is honoured. Files with latches, justice or fairness properties are rejected, bad state
+// and invariant constraint literals are skipped.
+inline bool read_binary_aiger( const char* data, size_t size, aig_ntk& ntk )
+{
+    if ( !is_binary_aiger( data, size ) )
+    {
+        return false;
+    }
+    detail::aiger_cursor in{ data + 4u, data + size };
+
+    // header: aig M I L O A [B C J F]
+    uint64_t header[9] = { 0u };
+    size_t num_fields = 0u;
+    while ( num_fields < 9u && in.read_number( header[num_fields] ) )
+    {
+        ++num_fields;
+        if ( !in.skip( ' ' ) )
+        {
+            break;
+        }
+    }
+    const uint64_t max_var = header[0], num_inputs = header[1], num_latches = header[2];
+    const uint64_t num_outputs = header[3], num_ands = header[4];
+    if ( num_fields < 5u || !in.skip( '\n' ) || num_latches != 0u || header[7] != 0u || header[8] != 0u ||
+         max_var != num_inputs + num_ands || max_var >= ( 1u << 30 ) )
+    {
+        return false;
+    }
+
+    // outputs, then bad state and constraint literals that are not used
+    std::vector<uint32_t> outputs( num_outputs );
+    for ( uint64_t i = 0; i < num_outputs + header[5] + header[6]; ++i )
+    {
+        uint64_t lit;
+        if ( !in.read_number( lit ) || !in.skip( '\n' ) || lit > 2u * max_var + 1u )
+        {
+            return false;
+        }
+        if ( i < num_outputs )
+        {
+            outputs[i] = static_cast<uint32_t>( lit );
+        }
+    }
+
+    ntk.set_num_pis( static_cast<uint32_t>( num_inputs ) );
+    ntk.set_num_pos( static_cast<uint32_t>( num_outputs ) );
+    ntk.set_num_gates( static_cast<uint32_t>( num_ands ) );
+    ntk.create_constant();
+    for ( uint64_t i = 0; i < num_inputs; ++i )
+    {
+        ntk.create_pi();
+    }
+
+    // network literal of each AIGER variable, only needed once structural hashing merges gates
+    std::vector<uint32_t> lits;
+    if ( ntk.is_strash() )
+    {
+        lits.resize( max_var + 1u );
+        for ( uint32_t v = 0; v <= num_inputs; ++v )
+        {
+            lits[v] = v << 1;
+        }
+    }
+    auto to_lit = [&]( uint32_t lit ) { return lits.empty() ? lit : lits[lit >> 1] ^ ( lit & 1u ); };
+
+    uint32_t lhs = static_cast<uint32_t>( 2u * num_inputs );
+    for ( uint64_t i = 0; i < num_ands; ++i )
+    {
+        lhs += 2u;
+        uint32_t delta0, delta1;
+        if ( !in.read_delta( delta0 ) || !in.read_delta( delta1 ) || delta0 == 0u || delta0 > lhs ||
+             delta1 > lhs - delta0 )
+        {
+            return false;
+        }
+        uint32_t rhs0 = lhs - delta0;
+        uint32_t rhs1 = rhs0 - delta1;
+        // without strash every gate keeps its node, so x & x becomes x & 1 and x & !x becomes x & 0;
+        // a gate on the constant alone cannot be kept that way
+        if ( delta1 <= 1u && !ntk.is_strash() && ( rhs0 >> 1 ) == ( rhs1 >> 1 ) )
+        {
+            if ( rhs1 < 2u )
+            {
+                return false;
+            }
+            rhs1 = delta1 == 0u ? 1u : 0u;
+        }
+        uint32_t lit = ntk.create_and_lit( to_lit( rhs0 ), to_lit( rhs1 ) );
+        if ( !lits.empty() )
+        {
+            lits[lhs >> 1] = lit;
+        }
+    }
+
+    // the symbol table and comments are not needed
+    for ( uint32_t lit : outputs )
+    {
+        ntk.create_po_lit( to_lit( lit ) );
+    }
+    ntk.build_fanouts();
+    return true;
+}
+
+inline bool read_binary_aiger( const std::string& filename, aig_ntk& ntk )
+{
+    mapped_file file( filename );
+    return file.is_open() && read_binary_aiger( file.data(), file.size(), ntk );
+}
+
+} // namespace cirsat
+
+#endif // CIRSAT_AIGER_MMAP_READER_HPP
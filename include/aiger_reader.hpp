@@ -22,16 +22,11 @@ template <typename Ntk> class aiger_reader : public lorina::aiger_reader
 
     void process_outputs() const
     {
-        for ( auto out : outputs )
+        for ( auto lit : _outputs )
         {
-            auto const lit = std::get<0>( out );
-            auto gate = _ntk.get_gates()[lit >> 1];
-            if ( lit & 1 )
-            {
-                gate = _ntk.create_not( gate );
-            }
-            _ntk.create_po( gate );
+            _ntk.create_po_lit( to_lit( lit ) );
         }
+        _ntk.build_fanouts();
     }
 
     void on_header( uint64_t, uint64_t num_inputs, uint64_t num_latches, uint64_t num_outputs,
@@ -42,49 +37,56 @@ template <typename Ntk> class aiger_reader : public lorina::aiger_reader
         _ntk.set_num_pis( static_cast<uint32_t>( num_inputs ) );
         _ntk.set_num_pos( static_cast<uint32_t>( num_outputs ) );
         _ntk.set_num_gates( static_cast<uint32_t>( num_ands ) );
-        _ntk.add_gate( gate( 0 ) );
+        _ntk.create_constant();
+        _outputs.reserve( num_outputs );
 
         /* create primary inputs (pi) */
         for ( auto i = 0u; i < num_inputs; ++i )
         {
             _ntk.create_pi();
         }
+
+        /* the constant and the inputs keep their AIGER literals */
+        _lits.resize( num_inputs + num_ands + 1 );
+        for ( auto i = 0u; i <= num_inputs; ++i )
+        {
+            _lits[i] = i << 1;
+        }
     }
 
     void on_and( unsigned index, unsigned left_lit, unsigned right_lit ) const override
     {
-        (void)index;
-        assert( _ntk.get_gates().size() == index );
-
-        auto left = _ntk.get_gates()[left_lit >> 1];
-        if ( left_lit & 1 )
+        _lits[index] = _ntk.create_and_lit( to_lit( left_lit ), to_lit( right_lit ) );
+        if ( ++_num_ands == _ntk.get_num_gates() )
         {
-            left = _ntk.create_not( left );
+            process_outputs();
         }
+    }
 
-        auto right = _ntk.get_gates()[right_lit >> 1];
-        if ( right_lit & 1 )
-        {
-            right = _ntk.create_not( right );
-        }
+    void on_output( unsigned index, unsigned lit ) const override
+    {
+        (void)index;
 
-        _ntk.create_and( left, right );
-        if ( _ntk.get_gates().size() == _ntk.get_num_gates() + _ntk.get_num_pis() + 1 )
+        _outputs.push_back( lit );
+        // without AND gates on_and is never called, the outputs are complete here
+        if ( _ntk.get_num_gates() == 0u && _outputs.size() == _ntk.get_num_pos() )
         {
             process_outputs();
         }
     }
 
-    void on_output( unsigned index, unsigned lit ) const override
+  private:
+    // Network literal of an AIGER literal, they differ once structural hashing merged gates
+    uint32_t to_lit( unsigned lit ) const
     {
-        (void)index;
-
-        outputs.emplace_back( lit, "" );
+        return _lits[lit >> 1] ^ ( lit & 1u );
     }
 
   private:
     Ntk& _ntk;
-    mutable std::vector<std::tuple<unsigned, std::string>> outputs;
+    mutable std::vector<uint32_t> _lits;
+    mutable uint32_t _num_ands{ 0u };
+    mutable std::vector<uint32_t> _outputs;
 };
 
 } // namespace cirsat
@@ -0,0 +1,237 @@
+/**
+ * @file cube_and_conquer.hpp
+ * @brief Cube-and-conquer: lookahead splitting and a work-stealing pool of cube solvers
+ * @copyright Copyright (c) 2023- Zhufei Chu, Ningbo University. MIT License.
+ */
+
+#ifndef CIRSAT_CUBE_AND_CONQUER_HPP
+#define CIRSAT_CUBE_AND_CONQUER_HPP
+
+#include "aig.hpp"
+#include "aig_dpll_solver.hpp"
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <istream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace cirsat {
+
+struct cube_params {
+    // cubes aimed at: the lookahead splits up to ceil( log2( num_cubes ) ) decisions deep
+    uint32_t num_cubes{ 1024u };
+    // J-frontier fanins probed at each split
+    uint32_t num_candidates{ 16u };
+    uint32_t num_threads{ 1u };
+};
+
+// Outcome of one cube, unknown if it was not finished when another cube was found SAT or it
+// reached the conflict limit
+struct cube_report {
+    sat_status status{ sat_status::unknown };
+    double seconds{ 0.0 };
+    uint32_t worker{ 0u };
+};
+
+// Split ntk into cubes by lookahead, see aig_dpll_solver::lookahead. Returns true with solution
+// filled if the lookahead itself finds a satisfying assignment.
+inline bool generate_cubes( const aig_ntk& ntk, const aig_dpll_params& ps, const cube_params& cps,
+                            std::vector<std::vector<uint32_t>>& cubes, std::vector<bool>& solution )
+{
+    uint32_t depth = 0u;
+    while ( ( 1u << depth ) < cps.num_cubes && depth < 31u )
+    {
+        ++depth;
+    }
+    aig_dpll_solver solver( ntk, ps );
+    return solver.lookahead( depth, cps.num_candidates, cubes, solution );
+}
+
+// Solve every cube with its own aig_dpll_solver on num_threads workers. Each worker owns a
+// deque holding a contiguous block of the cubes, it takes work from the back of its own deque
+// and, once it is empty, steals from the front of the others. The first SAT cube stops the
+// other workers. Without a SAT cube the status is unsat if every cube is, unknown otherwise.
+// reports gets one entry per cube.
+inline solve_result solve_cubes( const aig_ntk& ntk, const aig_dpll_params& ps,
+                                 const std::vector<std::vector<uint32_t>>& cubes, uint32_t num_threads,
+                                 std::vector<cube_report>& reports )
+{
+    struct work_queue {
+        std::mutex mutex;
+        std::deque<uint32_t> cubes;
+    };
+
+    num_threads = std::max( 1u, num_threads );
+    const uint32_t num_cubes = static_cast<uint32_t>( cubes.size() );
+    std::vector<std::unique_ptr<work_queue>> queues;
+    for ( uint32_t w = 0; w < num_threads; ++w )
+    {
+        queues.emplace_back( new work_queue );
+        for ( uint32_t i = static_cast<uint64_t>( num_cubes ) * w / num_threads;
+              i < static_cast<uint64_t>( num_cubes ) * ( w + 1 ) / num_threads; ++i )
+        {
+            queues[w]->cubes.push_back( i );
+        }
+    }
+
+    auto take = [&]( uint32_t w, uint32_t& index ) {
+        for ( uint32_t k = 0; k < num_threads; ++k )
+        {
+            work_queue& q = *queues[( w + k ) % num_threads];
+            std::lock_guard<std::mutex> lock( q.mutex );
+            if ( q.cubes.empty() )
+            {
+                continue;
+            }
+            if ( k == 0u )
+            {
+                index = q.cubes.back();
+                q.cubes.pop_back();
+            }
+            else
+            {
+                index = q.cubes.front();
+                q.cubes.pop_front();
+            }
+            return true;
+        }
+        return false;
+    };
+
+    reports.assign( num_cubes, cube_report() );
+    std::atomic<bool> stop{ false };
+    std::mutex result_mutex;
+    solve_result result{ sat_status::unsat, std::nullopt };
+
+    auto work = [&]( uint32_t w ) {
+        uint32_t index;
+        while ( !stop.load( std::memory_order_relaxed ) && take( w, index ) )
+        {
+            auto start = std::chrono::steady_clock::now();
+            aig_dpll_solver solver( ntk, ps );
+            solver.set_stop_flag( &stop );
+            std::vector<bool> solution;
+            bool is_sat = solver.solve_cube( solution, cubes[index] );
+
+            cube_report& report = reports[index];
+            report.seconds = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+            report.worker = w;
+            if ( solver.interrupted() )
+            {
+                continue;
+            }
+            report.status = solver.status( is_sat );
+            if ( is_sat )
+            {
+                std::lock_guard<std::mutex> lock( result_mutex );
+                if ( !stop.exchange( true ) )
+                {
+                    result = { sat_status::sat, std::move( solution ) };
+                }
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for ( uint32_t w = 1; w < num_threads; ++w )
+    {
+        threads.emplace_back( work, w );
+    }
+    work( 0u );
+    for ( auto& thread : threads )
+    {
+        thread.join();
+    }
+    if ( result.first == sat_status::unsat )
+    {
+        for ( const auto& report : reports )
+        {
+            if ( report.status == sat_status::unknown )
+            {
+                result.first = sat_status::unknown;
+                break;
+            }
+        }
+    }
+    return result;
+}
+
+// Simulation fast path, then lookahead followed by solve_cubes
+inline solve_result solve_aig_cube_and_conquer( const aig_ntk& ntk, const aig_dpll_params& ps, const cube_params& cps,
+                                                std::vector<cube_report>& reports )
+{
+    std::vector<std::vector<uint32_t>> cubes;
+    std::vector<bool> solution;
+    reports.clear();
+    if ( simulate_first( ntk, ps, solution ) || generate_cubes( ntk, ps, cps, cubes, solution ) )
+    {
+        return { sat_status::sat, std::move( solution ) };
+    }
+    return solve_cubes( ntk, ps, cubes, cps.num_threads, reports );
+}
+
+// Cubes in the iCNF style of lookahead solvers: one line "a <lit> ... 0" per cube, where the
+// literal ( n << 1 ) | complement, true in the cube, is written n or -n. Node ids depend on the network,
+// the same file must be loaded with the same options to solve the cubes.
+inline void write_cubes( std::ostream& os, const std::vector<std::vector<uint32_t>>& cubes )
+{
+    for ( const auto& cube : cubes )
+    {
+        os << "a";
+        for ( uint32_t lit : cube )
+        {
+            os << ' ' << ( aig_ntk::data_to_complement( lit ) ? "-" : "" ) << aig_ntk::data_to_index( lit );
+        }
+        os << " 0\n";
+    }
+}
+
+// Read cubes written by write_cubes, other lines are ignored. Returns false on a malformed cube
+// or a node that is not in ntk.
+inline bool read_cubes( std::istream& is, const aig_ntk& ntk, std::vector<std::vector<uint32_t>>& cubes )
+{
+    std::string line;
+    while ( std::getline( is, line ) )
+    {
+        std::istringstream tokens( line );
+        std::string head;
+        if ( !( tokens >> head ) || head != "a" )
+        {
+            continue;
+        }
+        std::vector<uint32_t> cube;
+        bool terminated = false;
+        int64_t lit;
+        while ( tokens >> lit )
+        {
+            if ( lit == 0 )
+            {
+                terminated = true;
+                break;
+            }
+            uint64_t node = static_cast<uint64_t>( lit < 0 ? -lit : lit );
+            if ( node >= ntk.num_nodes() )
+            {
+                return false;
+            }
+            cube.push_back( static_cast<uint32_t>( node << 1 ) | ( lit < 0 ? 1u : 0u ) );
+        }
+        if ( !terminated )
+        {
+            return false;
+        }
+        cubes.push_back( std::move( cube ) );
+    }
+    return true;
+}
+
+} // namespace cirsat
+
+#endif // CIRSAT_CUBE_AND_CONQUER_HPP
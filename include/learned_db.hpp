@@ -0,0 +1,166 @@
+/**
+ * @file learned_db.hpp
+ * @brief Storage of the learned constraints of the circuit solver
+ * @copyright Copyright (c) 2023- Zhufei Chu, Ningbo University. MIT License.
+ */
+
+#ifndef CIRSAT_LEARNED_DB_HPP
+#define CIRSAT_LEARNED_DB_HPP
+
+#include "aig.hpp"
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+namespace cirsat {
+
+// Handle of a learned constraint inside a learned_db
+using LearnedRef = uint32_t;
+constexpr LearnedRef INVALID_LEARNED = NULL_INDEX;
+
+// Tiers of the learned constraints, from never removed to first candidates for removal
+enum class learned_tier : uint8_t { core, tier2, local };
+
+// Learned constraints watching a node, indexed by [value][node]
+using Learned_WatchLists = std::array<std::vector<std::vector<LearnedRef>>, 2>;
+
+// Learned OR gates kept outside of the network. A learned gate is satisfied unless every
+// input node takes its watch value, its literals are ( node << 1 ) | watch_value and are
+// stored contiguously in one arena. Handles of removed constraints are reused, the arena
+// space they occupied is reclaimed by compact().
+class learned_db
+{
+  public:
+    struct constraint {
+        uint32_t offset;
+        uint32_t size;
+        uint32_t lbd;
+        float activity;
+        learned_tier tier;
+        bool removed;
+        bool used; // took part in a conflict since the last reduction
+    };
+
+    LearnedRef add( const std::vector<uint32_t>& lits, uint32_t lbd = 0u, learned_tier tier = learned_tier::local )
+    {
+        assert( !lits.empty() );
+        constraint c{ static_cast<uint32_t>( m_lits.size() ), static_cast<uint32_t>( lits.size() ), lbd, 0.0f, tier,
+                      false, false };
+        m_lits.insert( m_lits.end(), lits.begin(), lits.end() );
+        ++m_num_live;
+
+        if ( !m_free.empty() )
+        {
+            LearnedRef ref = m_free.back();
+            m_free.pop_back();
+            m_constraints[ref] = c;
+            return ref;
+        }
+        m_constraints.push_back( c );
+        return static_cast<LearnedRef>( m_constraints.size() - 1 );
+    }
+
+    // The caller must have dropped every watch and reason referring to ref
+    void remove( LearnedRef ref )
+    {
+        assert( !m_constraints[ref].removed );
+        m_constraints[ref].removed = true;
+        m_wasted += m_constraints[ref].size;
+        m_free.push_back( ref );
+        --m_num_live;
+    }
+
+    // Move the literals of the remaining constraints to a fresh arena once half of it is unused
+    void compact()
+    {
+        if ( m_wasted * 2 < m_lits.size() )
+        {
+            return;
+        }
+        std::vector<uint32_t> lits;
+        lits.reserve( m_lits.size() - m_wasted );
+        for ( auto& c : m_constraints )
+        {
+            if ( c.removed )
+            {
+                continue;
+            }
+            uint32_t offset = static_cast<uint32_t>( lits.size() );
+            lits.insert( lits.end(), m_lits.begin() + c.offset, m_lits.begin() + c.offset + c.size );
+            c.offset = offset;
+        }
+        m_lits.swap( lits );
+        m_wasted = 0u;
+    }
+
+    constraint& info( LearnedRef ref )
+    {
+        return m_constraints[ref];
+    }
+    const constraint& info( LearnedRef ref ) const
+    {
+        return m_constraints[ref];
+    }
+
+    uint32_t* lits( LearnedRef ref )
+    {
+        return m_lits.data() + m_constraints[ref].offset;
+    }
+    const uint32_t* lits( LearnedRef ref ) const
+    {
+        return m_lits.data() + m_constraints[ref].offset;
+    }
+    uint32_t size( LearnedRef ref ) const
+    {
+        return m_constraints[ref].size;
+    }
+
+    // Upper bound of the handles in use, some of them may be removed
+    uint32_t capacity() const
+    {
+        return static_cast<uint32_t>( m_constraints.size() );
+    }
+    uint32_t num_constraints() const
+    {
+        return m_num_live;
+    }
+    uint64_t num_literals() const
+    {
+        return m_lits.size() - m_wasted;
+    }
+
+    // Release all learned constraints, the watch lists referring to them must be cleared too
+    void clear()
+    {
+        std::vector<constraint>().swap( m_constraints );
+        std::vector<uint32_t>().swap( m_lits );
+        std::vector<LearnedRef>().swap( m_free );
+        m_wasted = 0u;
+        m_num_live = 0u;
+    }
+
+    static GateId lit_node( uint32_t lit )
+    {
+        return lit >> 1;
+    }
+    static bool lit_watch_value( uint32_t lit )
+    {
+        return lit & 1;
+    }
+    static uint32_t make_lit( GateId node, bool watch_value )
+    {
+        return ( node << 1 ) | ( watch_value ? 1u : 0u );
+    }
+
+  private:
+    std::vector<constraint> m_constraints;
+    std::vector<uint32_t> m_lits;
+    std::vector<LearnedRef> m_free;
+    uint64_t m_wasted{ 0u };
+    uint32_t m_num_live{ 0u };
+};
+
+} // namespace cirsat
+
+#endif // CIRSAT_LEARNED_DB_HPP
@@ -0,0 +1,127 @@
+/**
+ * @file learned_exchange.hpp
+ * @brief Lock-free ring buffer sharing short learned gates between portfolio solvers
+ * @copyright Copyright (c) 2023- Zhufei Chu, Ningbo University. MIT License.
+ */
+
+#ifndef CIRSAT_LEARNED_EXCHANGE_HPP
+#define CIRSAT_LEARNED_EXCHANGE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace cirsat {
+
+// Broadcast ring of learned gates, in learned_db literals, between solvers working on the same
+// network. Any solver publishes, every solver reads the gates of the others from its own cursor.
+// Each slot is guarded by a sequence number in the manner of a seqlock: a writer makes it odd
+// while copying and publishes 2 * ( position + 1 ), a reader keeps a copy only if the number
+// was that value before and after copying. Sharing is best effort: a gate is dropped when its
+// slot is still being written by a writer that went round the ring, and a reader that falls
+// more than one ring behind loses the oldest gates.
+class learned_exchange
+{
+  public:
+    static constexpr uint32_t MAX_LITS = 16u;
+
+    // capacity is rounded up to a power of two
+    explicit learned_exchange( size_t capacity = 4096u )
+    {
+        size_t size = 1u;
+        while ( size < capacity )
+        {
+            size <<= 1;
+        }
+        m_slots.reset( new slot[size] );
+        m_mask = size - 1u;
+    }
+
+    learned_exchange( const learned_exchange& ) = delete;
+    learned_exchange& operator=( const learned_exchange& ) = delete;
+
+    // Returns false if the gate is too long or its slot is busy
+    bool publish( uint32_t source, const uint32_t* lits, uint32_t size, uint32_t lbd )
+    {
+        if ( size == 0u || size > MAX_LITS )
+        {
+            return false;
+        }
+        uint64_t pos = m_tail.fetch_add( 1u, std::memory_order_relaxed );
+        slot& s = m_slots[pos & m_mask];
+        uint64_t seq = s.seq.load( std::memory_order_relaxed );
+        if ( ( seq & 1u ) || !s.seq.compare_exchange_strong( seq, 2u * pos + 1u, std::memory_order_relaxed ) )
+        {
+            return false;
+        }
+        std::atomic_thread_fence( std::memory_order_release );
+        s.source.store( source, std::memory_order_relaxed );
+        s.size.store( size, std::memory_order_relaxed );
+        s.lbd.store( lbd, std::memory_order_relaxed );
+        for ( uint32_t i = 0; i < size; ++i )
+        {
+            s.lits[i].store( lits[i], std::memory_order_relaxed );
+        }
+        s.seq.store( 2u * pos + 2u, std::memory_order_release );
+        return true;
+    }
+
+    // Position following the last published gate
+    uint64_t tail() const
+    {
+        return m_tail.load( std::memory_order_acquire );
+    }
+
+    // Call fn( lits, size, lbd ) for the gates published by other sources since cursor, which is
+    // advanced past them
+    template <typename Fn> void collect( uint32_t source, uint64_t& cursor, Fn&& fn ) const
+    {
+        uint64_t end = tail();
+        if ( end - cursor > m_mask + 1u )
+        {
+            cursor = end - ( m_mask + 1u );
+        }
+        uint32_t lits[MAX_LITS];
+        for ( ; cursor < end; ++cursor )
+        {
+            const slot& s = m_slots[cursor & m_mask];
+            uint64_t seq = s.seq.load( std::memory_order_acquire );
+            if ( seq != 2u * cursor + 2u )
+            {
+                continue;
+            }
+            uint32_t from = s.source.load( std::memory_order_relaxed );
+            uint32_t size = s.size.load( std::memory_order_relaxed );
+            uint32_t lbd = s.lbd.load( std::memory_order_relaxed );
+            for ( uint32_t i = 0; i < size && i < MAX_LITS; ++i )
+            {
+                lits[i] = s.lits[i].load( std::memory_order_relaxed );
+            }
+            std::atomic_thread_fence( std::memory_order_acquire );
+            if ( s.seq.load( std::memory_order_relaxed ) != seq || from == source )
+            {
+                continue;
+            }
+            fn( lits, size, lbd );
+        }
+    }
+
+  private:
+    struct slot {
+        std::atomic<uint64_t> seq{ 0u };
+        std::atomic<uint32_t> source{ 0u };
+        std::atomic<uint32_t> size{ 0u };
+        std::atomic<uint32_t> lbd{ 0u };
+        std::atomic<uint32_t> lits[MAX_LITS];
+    };
+
+    std::unique_ptr<slot[]> m_slots;
+    size_t m_mask{ 0u };
+    std::atomic<uint64_t> m_tail{ 0u };
+};
+
+} // namespace cirsat
+
+#endif // CIRSAT_LEARNED_EXCHANGE_HPP
@@ -133,8 +133,8 @@ class mffc_view
         _node_to_index.clear();
         _node_to_index.emplace( 0u, 0u );
 
-        auto const& gates = _ntk.get_gates();
-        _is_pi.assign( gates.size(), false );
+        auto const num_nodes = _ntk.num_nodes();
+        _is_pi.assign( num_nodes, false );
         for ( auto const& pi : _ntk.get_inputs() )
         {
             if ( pi < _is_pi.size() )
@@ -143,11 +143,11 @@ class mffc_view
             }
         }
 
-        // initialize refcounts from fanout sizes (info[0])
-        _refcnt.assign( gates.size(), 0u );
-        for ( uint32_t i = 0; i < gates.size(); ++i )
+        // initialize refcounts from the references of the network
+        _refcnt.assign( num_nodes, 0u );
+        for ( uint32_t i = 0; i < num_nodes; ++i )
         {
-            _refcnt[i] = gates[i].info[0];
+            _refcnt[i] = _ntk.get_num_refs( i );
         }
 
         if ( is_constant( _root ) )
@@ -182,8 +182,7 @@ class mffc_view
             return true;
         }
 
-        auto const& g = _ntk.get_gates()[n];
-        for ( auto const child_data : g.children )
+        for ( auto const child_data : _ntk.get_children( n ) )
         {
             node child = aig_ntk::data_to_index( child_data );
             _nodes.push_back( child );
@@ -291,8 +290,7 @@ class mffc_view
 
         _colors[idx] = 1u;
 
-        auto const& g = _ntk.get_gates()[n];
-        for ( auto const child_data : g.children )
+        for ( auto const child_data : _ntk.get_children( n ) )
         {
             node child = aig_ntk::data_to_index( child_data );
             topo_sort_rec( child );
@@ -0,0 +1,126 @@
+/**
+ * @file output_solver.hpp
+ * @brief Independent solving of each output on its own cone of influence
+ * @copyright Copyright (c) 2023- Zhufei Chu, Ningbo University. MIT License.
+ */
+
+#ifndef CIRSAT_OUTPUT_SOLVER_HPP
+#define CIRSAT_OUTPUT_SOLVER_HPP
+
+#include "aig.hpp"
+#include "aig_cone.hpp"
+#include "aig_dpll_solver.hpp"
+#include "aig_simulator.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <optional>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace cirsat {
+
+// Size of the cone an output was solved on and the time it took
+struct output_report {
+    uint32_t cone_nodes{ 0u };
+    uint32_t cone_inputs{ 0u };
+    double seconds{ 0.0 };
+};
+
+// Decide every output of ntk on its own: is there an input assignment setting it to 1. Each
+// output is solved by an aig_dpll_solver on its transitive fanin cone, extracted and densely
+// renumbered by extract_cone, so that the solver never sees the rest of the network. The
+// simulation fast path runs once on the whole network first, an output it sets to 1 is SAT
+// without a cone and keeps an empty report. The other outputs are handed out to num_threads
+// workers one at a time. A solution has one value per input of ntk,
+// the inputs outside of the cone are 0; an output whose solver reached the conflict limit is
+// unknown. reports gets one entry per output.
+inline std::vector<solve_result>
+solve_aig_outputs( const aig_ntk& ntk, const aig_dpll_params& ps, uint32_t num_threads,
+                   std::vector<output_report>& reports )
+{
+    const auto& outputs = ntk.get_outputs();
+    const uint32_t num_outputs = static_cast<uint32_t>( outputs.size() );
+    const size_t num_inputs = ntk.get_inputs().size();
+    std::vector<solve_result> results( num_outputs, { sat_status::unknown, std::nullopt } );
+    reports.assign( num_outputs, output_report() );
+
+    if ( ps.sat_simulation_rounds > 0u && num_outputs > 0u )
+    {
+        aig_simulator sim( ntk, simulation_words( ntk, ps ) );
+        std::mt19937_64 rng( ps.seed );
+        for ( uint32_t round = 0; round < ps.sat_simulation_rounds; ++round )
+        {
+            sim.randomize_inputs( rng );
+            sim.simulate();
+            for ( uint32_t index = 0; index < num_outputs; ++index )
+            {
+                int64_t pattern;
+                if ( results[index].first != sat_status::sat && ( pattern = sim.find_pattern( outputs[index] ) ) >= 0 )
+                {
+                    std::vector<bool> values;
+                    sim.input_pattern( static_cast<uint64_t>( pattern ), values );
+                    results[index] = { sat_status::sat, std::move( values ) };
+                }
+            }
+        }
+    }
+    std::atomic<uint32_t> next{ 0u };
+
+    auto work = [&]() {
+        uint32_t index;
+        while ( ( index = next.fetch_add( 1u, std::memory_order_relaxed ) ) < num_outputs )
+        {
+            if ( results[index].first == sat_status::sat )
+            {
+                continue;
+            }
+            auto start = std::chrono::steady_clock::now();
+            aig_ntk cone;
+            std::vector<GateId> inputs;
+            uint32_t root = extract_cone( ntk, { outputs[index] }, cone, false, &inputs )[0];
+            output_report& report = reports[index];
+            report.cone_nodes = cone.num_nodes();
+            report.cone_inputs = static_cast<uint32_t>( inputs.size() );
+
+            // a constant output needs no search, any assignment satisfies constant 1
+            std::vector<bool> solution;
+            sat_status status = root == 1u ? sat_status::sat : sat_status::unsat;
+            if ( root > 1u )
+            {
+                cone.create_po_lit( root );
+                cone.build_fanouts();
+                aig_dpll_solver solver( cone, ps );
+                status = solver.status( solver.solve( solution ) );
+            }
+            results[index].first = status;
+            if ( status == sat_status::sat )
+            {
+                std::vector<bool> values( num_inputs, false );
+                for ( size_t k = 0; k < solution.size(); ++k )
+                {
+                    values[inputs[k] - 1u] = solution[k];
+                }
+                results[index].second = std::move( values );
+            }
+            report.seconds = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for ( uint32_t w = 1; w < std::max( 1u, num_threads ); ++w )
+    {
+        threads.emplace_back( work );
+    }
+    work();
+    for ( auto& thread : threads )
+    {
+        thread.join();
+    }
+    return results;
+}
+
+} // namespace cirsat
+
+#endif // CIRSAT_OUTPUT_SOLVER_HPP
@@ -0,0 +1,115 @@
+/**
+ * @file portfolio.hpp
+ * @brief Parallel portfolio of circuit solvers racing on one network
+ * @copyright Copyright (c) 2023- Zhufei Chu, Ningbo University. MIT License.
+ */
+
+#ifndef CIRSAT_PORTFOLIO_HPP
+#define CIRSAT_PORTFOLIO_HPP
+
+#include "aig.hpp"
+#include "aig_dpll_solver.hpp"
+#include "learned_exchange.hpp"
+#include <atomic>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+namespace cirsat {
+
+// Parameters of the portfolio member i: member 0 runs ps unchanged, the next ones combine other
+// decision heuristics, restart policies and phases, and past the table the combinations repeat
+// with randomly simulated initial phases drawn from different seeds.
+inline aig_dpll_params portfolio_params( const aig_dpll_params& ps, uint32_t i )
+{
+    struct config {
+        decision_strategy decision;
+        restart_policy restart;
+        phase_policy phase;
+        bool simulation_phase;
+    };
+    static const config configs[] = {
+        { decision_strategy::vsids, restart_policy::glucose, phase_policy::saved, false },
+        { decision_strategy::vsids, restart_policy::luby, phase_policy::target, false },
+        { decision_strategy::jfrontier_fanout, restart_policy::luby, phase_policy::saved, false },
+        { decision_strategy::vsids, restart_policy::geometric, phase_policy::target, true },
+        { decision_strategy::jfrontier_fanout, restart_policy::glucose, phase_policy::target, true },
+        { decision_strategy::vsids, restart_policy::glucose, phase_policy::fixed, true },
+    };
+    constexpr uint32_t num_configs = sizeof( configs ) / sizeof( configs[0] );
+
+    aig_dpll_params member = ps;
+    if ( i == 0u )
+    {
+        return member;
+    }
+    const config& c = configs[( i - 1u ) % num_configs];
+    member.decision = c.decision;
+    member.restart = c.restart;
+    member.phase = c.phase;
+    member.simulation_phase = c.simulation_phase || i > num_configs;
+    member.seed = ps.seed + i;
+    return member;
+}
+
+// Run num_threads solvers configured by portfolio_params concurrently on ntk, which is only
+// read. Unless ps.share_learned is off, short learned gates are passed between them through a
+// learned_exchange. The first one to finish gives the answer and the others are stopped at
+// their next decision; the status is unknown if every solver reached the conflict limit. The
+// simulation fast path runs once before the solvers start. With a single thread this is solve_aig.
+inline solve_result solve_aig_portfolio( const aig_ntk& ntk, const aig_dpll_params& ps, uint32_t num_threads )
+{
+    if ( num_threads <= 1u )
+    {
+        return solve_aig( ntk, ps );
+    }
+
+    std::vector<bool> simulated;
+    if ( simulate_first( ntk, ps, simulated ) )
+    {
+        return { sat_status::sat, std::move( simulated ) };
+    }
+
+    std::atomic<bool> stop{ false };
+    learned_exchange exchange;
+    std::mutex result_mutex;
+    solve_result result{ sat_status::unknown, std::nullopt };
+
+    std::vector<std::thread> threads;
+    threads.reserve( num_threads );
+    for ( uint32_t i = 0; i < num_threads; ++i )
+    {
+        threads.emplace_back( [&, i]() {
+            aig_dpll_solver solver( ntk, portfolio_params( ps, i ) );
+            solver.set_stop_flag( &stop );
+            solver.set_exchange( &exchange, i );
+            std::vector<bool> solution;
+            bool is_sat = solver.solve( solution );
+            if ( solver.interrupted() )
+            {
+                return;
+            }
+
+            std::lock_guard<std::mutex> lock( result_mutex );
+            if ( stop.exchange( true ) )
+            {
+                return;
+            }
+            result.first = solver.status( is_sat );
+            if ( is_sat )
+            {
+                result.second = std::move( solution );
+            }
+        } );
+    }
+    for ( auto& thread : threads )
+    {
+        thread.join();
+    }
+    return result;
+}
+
+} // namespace cirsat
+
+#endif // CIRSAT_PORTFOLIO_HPP
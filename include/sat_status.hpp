@@ -0,0 +1,24 @@
+/**
+ * @file sat_status.hpp
+ * @brief Answer of a solve call
+ * @copyright Copyright (c) 2023- Zhufei Chu, Ningbo University. MIT License.
+ */
+
+#ifndef CIRSAT_SAT_STATUS_HPP
+#define CIRSAT_SAT_STATUS_HPP
+
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace cirsat {
+
+// unknown when the search gave up before deciding, on a conflict limit or a stop request
+enum class sat_status { unknown, sat, unsat };
+
+// Status of a solve call and, when it is sat, the value of every primary input
+using solve_result = std::pair<sat_status, std::optional<std::vector<bool>>>;
+
+} // namespace cirsat
+
+#endif // CIRSAT_SAT_STATUS_HPP
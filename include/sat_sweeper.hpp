@@ -0,0 +1,427 @@
+/**
+ * @file sat_sweeper.hpp
+ * @brief SAT sweeping: merge the equivalent nodes of an AIG, proved by the circuit solver
+ * @copyright Copyright (c) 2023- Zhufei Chu, Ningbo University. MIT License.
+ */
+
+#ifndef CIRSAT_SAT_SWEEPER_HPP
+#define CIRSAT_SAT_SWEEPER_HPP
+
+#include "aig.hpp"
+#include "aig_cone.hpp"
+#include "aig_dpll_solver.hpp"
+#include "aig_simulator.hpp"
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <vector>
+
+namespace cirsat {
+
+struct sweep_params {
+    // random patterns of the initial simulation, 64 per word
+    uint32_t num_words{ 16u };
+    // conflicts allowed to each equivalence query
+    uint64_t conflict_limit{ 100u };
+    uint64_t seed{ 1u };
+};
+
+struct sweep_stats {
+    uint32_t nodes_before{ 0u };
+    uint32_t nodes_after{ 0u };
+    uint64_t classes{ 0u };     // candidate classes after the initial simulation
+    uint64_t proved{ 0u };      // nodes merged into their representative
+    uint64_t refuted{ 0u };     // queries answered by a counterexample
+    uint64_t undecided{ 0u };   // queries that reached the conflict limit
+    uint64_t refinements{ 0u }; // resimulations of counterexamples
+    double seconds{ 0.0 };
+};
+
+// Candidate equivalences are classes of nodes with the same simulation signature, up to
+// complement. The network is rebuilt in topological order and each node is checked by a solver
+// call on the miter of their cones, with a conflict budget, against the first member of its class
+// that agrees with it on the buffered counterexamples. Proved nodes are replaced by that member.
+// Counterexamples are buffered up to 64 and only then resimulated on the whole network, which
+// splits the classes they distinguish; until then they are evaluated on the cones of the
+// candidates alone.
+class sat_sweeper
+{
+  public:
+    explicit sat_sweeper( const aig_ntk& ntk, const sweep_params& ps = {} )
+        : m_ntk( ntk ), m_ps( ps ), m_rng( ps.seed )
+    {
+    }
+
+    // Build the reduced network into swept, which must be empty. It has the same inputs and
+    // outputs as the original one.
+    void run( aig_ntk& swept )
+    {
+        auto start = std::chrono::steady_clock::now();
+        const GateId num_nodes = m_ntk.num_nodes();
+        const uint32_t num_inputs = static_cast<uint32_t>( m_ntk.get_inputs().size() );
+        m_st.nodes_before = num_nodes;
+        init_classes();
+
+        aig_ntk res;
+        res.set_strash( true );
+        res.set_num_pis( num_inputs );
+        res.set_num_gates( num_nodes - num_inputs - 1u );
+        res.create_constant();
+        m_map.assign( num_nodes, 0u );
+        for ( GateId pi : m_ntk.get_inputs() )
+        {
+            m_map[pi] = res.num_nodes() << 1;
+            res.create_pi();
+        }
+
+        for ( GateId id = num_inputs + 1u; id < num_nodes; ++id )
+        {
+            const auto& children = m_ntk.get_children( id );
+            uint32_t lit = res.create_and_lit( map_lit( children[0] ), map_lit( children[1] ) );
+            m_map[id] = lit;
+            while ( m_class_of[id] != NULL_INDEX )
+            {
+                GateId repr = candidate( id );
+                if ( repr == id )
+                {
+                    break;
+                }
+                uint32_t target = m_map[repr] ^ ( m_norm[id] ^ m_norm[repr] );
+                if ( lit == target )
+                {
+                    m_st.proved++;
+                    break;
+                }
+                if ( m_cex.size() >= 64u )
+                {
+                    refine();
+                    continue;
+                }
+                uint8_t result = query( res, lit, target );
+                if ( result == EQUIVALENT )
+                {
+                    m_map[id] = target;
+                    m_st.proved++;
+                    break;
+                }
+                if ( result == UNDECIDED )
+                {
+                    m_st.undecided++;
+                    break;
+                }
+                m_st.refuted++;
+            }
+        }
+
+        // drop the gates that lost their fanouts to merged nodes
+        std::vector<uint32_t> roots;
+        for ( uint32_t out : m_ntk.get_outputs() )
+        {
+            roots.push_back( map_lit( out ) );
+        }
+        for ( uint32_t lit : extract_cone( res, roots, swept, true ) )
+        {
+            swept.create_po_lit( lit );
+        }
+        swept.build_fanouts();
+        m_st.nodes_after = swept.num_nodes();
+        m_st.seconds = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+    }
+
+    const sweep_stats& stats() const
+    {
+        return m_st;
+    }
+
+  private:
+    static constexpr uint8_t EQUIVALENT = 0u;
+    static constexpr uint8_t DIFFERENT = 1u;
+    static constexpr uint8_t UNDECIDED = 2u;
+
+    uint32_t map_lit( uint32_t lit ) const
+    {
+        return m_map[aig_ntk::data_to_index( lit )] ^ ( lit & 1u );
+    }
+
+    // Signature of every node under random patterns, normalized so that the first pattern is 0
+    void init_classes()
+    {
+        const GateId num_nodes = m_ntk.num_nodes();
+        aig_simulator sim( m_ntk, std::max( 1u, m_ps.num_words ) );
+        sim.randomize_inputs( m_rng );
+        sim.simulate();
+
+        m_norm.assign( num_nodes, 0u );
+        std::vector<uint64_t> hash( num_nodes, 0u );
+        for ( GateId id = 0; id < num_nodes; ++id )
+        {
+            const uint64_t* row = sim.signature( id );
+            m_norm[id] = row[0] & 1u;
+            const uint64_t flip = m_norm[id] ? ~uint64_t( 0u ) : 0u;
+            uint64_t h = 0u;
+            for ( uint32_t w = 0; w < sim.num_words(); ++w )
+            {
+                h = ( h ^ ( row[w] ^ flip ) ) * 0x9e3779b97f4a7c15ull;
+            }
+            hash[id] = h;
+        }
+
+        auto same_row = [&]( GateId a, GateId b ) {
+            const uint64_t flip = ( m_norm[a] ^ m_norm[b] ) ? ~uint64_t( 0u ) : 0u;
+            const uint64_t *ra = sim.signature( a ), *rb = sim.signature( b );
+            for ( uint32_t w = 0; w < sim.num_words(); ++w )
+            {
+                if ( ra[w] != ( rb[w] ^ flip ) )
+                {
+                    return false;
+                }
+            }
+            return true;
+        };
+
+        std::vector<GateId> order( num_nodes );
+        for ( GateId id = 0; id < num_nodes; ++id )
+        {
+            order[id] = id;
+        }
+        std::sort( order.begin(), order.end(),
+                   [&]( GateId a, GateId b ) { return hash[a] != hash[b] ? hash[a] < hash[b] : a < b; } );
+
+        // nodes of a hash group that differ from its first member, a collision, are left alone
+        m_classes.clear();
+        for ( size_t i = 0; i < order.size(); )
+        {
+            size_t j = i + 1u;
+            while ( j < order.size() && hash[order[j]] == hash[order[i]] )
+            {
+                ++j;
+            }
+            std::vector<GateId> members;
+            for ( size_t k = i; k < j; ++k )
+            {
+                if ( same_row( order[i], order[k] ) )
+                {
+                    members.push_back( order[k] );
+                }
+            }
+            if ( members.size() > 1u )
+            {
+                m_classes.push_back( std::move( members ) );
+            }
+            i = j;
+        }
+        m_st.classes = m_classes.size();
+        index_classes();
+    }
+
+    // First member of the class of id, id itself if there is none before it, that takes the same
+    // values as id, up to complement, under every buffered counterexample
+    GateId candidate( GateId id )
+    {
+        for ( GateId member : m_classes[m_class_of[id]] )
+        {
+            if ( member == id || m_cex.empty() )
+            {
+                return member;
+            }
+            const uint64_t flip = ( m_norm[id] ^ m_norm[member] ) ? ~uint64_t( 0u ) : 0u;
+            const uint64_t mask = m_cex.size() >= 64u ? ~uint64_t( 0u ) : ( uint64_t( 1u ) << m_cex.size() ) - 1u;
+            if ( ( ( cex_values( id ) ^ cex_values( member ) ^ flip ) & mask ) == 0u )
+            {
+                return member;
+            }
+        }
+        return id;
+    }
+
+    // Values of id under the buffered counterexamples, bit k for counterexample k. Only the cone
+    // of id is evaluated, nodes already evaluated since the last change of the buffer are reused.
+    uint64_t cex_values( GateId id )
+    {
+        m_cex_stack.assign( 1u, id );
+        while ( !m_cex_stack.empty() )
+        {
+            GateId n = m_cex_stack.back();
+            if ( m_cex_stamp[n] == m_cex_epoch )
+            {
+                m_cex_stack.pop_back();
+                continue;
+            }
+            const auto& children = m_ntk.get_children( n );
+            GateId a = aig_ntk::data_to_index( children[0] ), b = aig_ntk::data_to_index( children[1] );
+            if ( m_cex_stamp[a] != m_cex_epoch )
+            {
+                m_cex_stack.push_back( a );
+                continue;
+            }
+            if ( m_cex_stamp[b] != m_cex_epoch )
+            {
+                m_cex_stack.push_back( b );
+                continue;
+            }
+            const uint64_t a_mask = aig_ntk::data_to_complement( children[0] ) ? ~uint64_t( 0u ) : 0u;
+            const uint64_t b_mask = aig_ntk::data_to_complement( children[1] ) ? ~uint64_t( 0u ) : 0u;
+            m_cex_words[n] = ( m_cex_words[a] ^ a_mask ) & ( m_cex_words[b] ^ b_mask );
+            m_cex_stamp[n] = m_cex_epoch;
+            m_cex_stack.pop_back();
+        }
+        return m_cex_words[id];
+    }
+
+    // Append a counterexample to the buffer, the constant and the inputs are up to date at once
+    void add_cex( std::vector<bool>&& pattern )
+    {
+        if ( m_cex_words.empty() )
+        {
+            m_cex_words.assign( m_ntk.num_nodes(), 0u );
+            m_cex_stamp.assign( m_ntk.num_nodes(), 0u );
+        }
+        const uint64_t bit = uint64_t( 1u ) << m_cex.size();
+        ++m_cex_epoch;
+        m_cex_stamp[0] = m_cex_epoch;
+        const auto& inputs = m_ntk.get_inputs();
+        for ( size_t i = 0; i < inputs.size(); ++i )
+        {
+            uint64_t& word = m_cex_words[inputs[i]];
+            word = m_cex.empty() ? 0u : word;
+            word = pattern[i] ? ( word | bit ) : ( word & ~bit );
+            m_cex_stamp[inputs[i]] = m_cex_epoch;
+        }
+        m_cex.push_back( std::move( pattern ) );
+    }
+
+    void index_classes()
+    {
+        m_class_of.assign( m_ntk.num_nodes(), NULL_INDEX );
+        for ( uint32_t c = 0; c < m_classes.size(); ++c )
+        {
+            for ( GateId id : m_classes[c] )
+            {
+                m_class_of[id] = c;
+            }
+        }
+    }
+
+    // Simulate the buffered counterexamples, the remaining bits of the word are random, and
+    // split every class by the new values
+    void refine()
+    {
+        aig_simulator sim( m_ntk, 1u );
+        const auto& inputs = m_ntk.get_inputs();
+        for ( size_t i = 0; i < inputs.size(); ++i )
+        {
+            uint64_t word = m_cex.size() < 64u ? m_rng() << m_cex.size() : 0u;
+            for ( size_t k = 0; k < m_cex.size(); ++k )
+            {
+                word |= static_cast<uint64_t>( m_cex[k][i] ) << k;
+            }
+            sim.signature( inputs[i] )[0] = word;
+        }
+        sim.simulate();
+        m_cex.clear();
+        m_st.refinements++;
+
+        auto key = [&]( GateId id ) { return sim.signature( id )[0] ^ ( m_norm[id] ? ~uint64_t( 0u ) : 0u ); };
+        std::vector<std::vector<GateId>> classes;
+        for ( auto& members : m_classes )
+        {
+            std::stable_sort( members.begin(), members.end(), [&]( GateId a, GateId b ) { return key( a ) < key( b ); } );
+            for ( size_t i = 0; i < members.size(); )
+            {
+                size_t j = i + 1u;
+                while ( j < members.size() && key( members[j] ) == key( members[i] ) )
+                {
+                    ++j;
+                }
+                if ( j - i > 1u )
+                {
+                    classes.emplace_back( members.begin() + i, members.begin() + j );
+                }
+                i = j;
+            }
+        }
+        m_classes.swap( classes );
+        index_classes();
+    }
+
+    // Check the literals a and b of res for equivalence on the miter of their cones. A
+    // counterexample is buffered for the next refinement.
+    uint8_t query( const aig_ntk& res, uint32_t a, uint32_t b )
+    {
+        aig_ntk miter;
+        std::vector<GateId> inputs;
+        auto roots = extract_cone( res, { a, b }, miter, false, &inputs );
+        uint32_t only_a = miter.create_and_lit( roots[0], roots[1] ^ 1u );
+        uint32_t only_b = miter.create_and_lit( roots[0] ^ 1u, roots[1] );
+        uint32_t differ = miter.create_and_lit( only_a ^ 1u, only_b ^ 1u ) ^ 1u;
+        if ( differ == 0u )
+        {
+            return EQUIVALENT;
+        }
+        miter.create_po_lit( differ );
+        miter.build_fanouts();
+
+        aig_dpll_params ps;
+        ps.conflict_limit = m_ps.conflict_limit;
+        ps.seed = m_rng();
+        aig_dpll_solver solver( miter, ps );
+        std::vector<bool> solution;
+        bool is_sat = solver.solve( solution );
+        if ( solver.interrupted() )
+        {
+            return UNDECIDED;
+        }
+        if ( !is_sat )
+        {
+            return EQUIVALENT;
+        }
+
+        // inputs outside of the cones take random values
+        std::vector<bool> pattern( m_ntk.get_inputs().size() );
+        uint64_t bits = 0u;
+        for ( size_t i = 0; i < pattern.size(); ++i )
+        {
+            if ( i % 64u == 0u )
+            {
+                bits = m_rng();
+            }
+            pattern[i] = ( bits >> ( i % 64u ) ) & 1u;
+        }
+        for ( size_t k = 0; k < inputs.size(); ++k )
+        {
+            pattern[inputs[k] - 1u] = solution[k];
+        }
+        add_cex( std::move( pattern ) );
+        return DIFFERENT;
+    }
+
+  private:
+    const aig_ntk& m_ntk;
+    sweep_params m_ps;
+    sweep_stats m_st;
+    std::mt19937_64 m_rng;
+    // per node: literal in the network being built, signature normalization bit, class
+    std::vector<uint32_t> m_map;
+    std::vector<uint8_t> m_norm;
+    std::vector<uint32_t> m_class_of;
+    // candidate classes, smallest index first, and counterexamples not simulated yet
+    std::vector<std::vector<GateId>> m_classes;
+    std::vector<std::vector<bool>> m_cex;
+    // per node: values under the buffered counterexamples, valid if the stamp is the current epoch
+    std::vector<uint64_t> m_cex_words;
+    std::vector<uint32_t> m_cex_stamp;
+    uint32_t m_cex_epoch{ 0u };
+    std::vector<GateId> m_cex_stack;
+};
+
+// Sweep ntk into swept, which must be empty
+inline sweep_stats sweep_aig( const aig_ntk& ntk, aig_ntk& swept, const sweep_params& ps = {} )
+{
+    sat_sweeper sweeper( ntk, ps );
+    sweeper.run( swept );
+    return sweeper.stats();
+}
+
+} // namespace cirsat
+
+#endif // CIRSAT_SAT_SWEEPER_HPP
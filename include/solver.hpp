@@ -7,13 +7,18 @@
 #ifndef CIRSAT_SOLVER_HPP
 #define CIRSAT_SOLVER_HPP
 
+#include "sat_status.hpp"
+#include <cstdint>
 #include <optional>
 #include <string>
 #include <utility>
 #include <vector>
 
 namespace cirsat {
-class aig_ntk; // Forward declaration
+class aig_ntk;          // Forward declaration
+struct aig_dpll_params; // Forward declaration
+struct sweep_params;    // Forward declaration
+struct sweep_stats;     // Forward declaration
 
 class Solver
 {
@@ -21,14 +26,35 @@ class Solver
     Solver();
     ~Solver();
 
-    // Load circuit from AIGER file
-    bool load_aiger( const std::string& filename );
+    // Load circuit from AIGER file, replacing the current one. Node n of network() is AIGER variable n unless
+    // strash is set, which merges trivial and structurally identical AND gates and renumbers the nodes.
+    bool load_aiger( const std::string& filename, bool strash = false );
+
+    // Replace the network by its SAT-swept version, see sat_sweeper
+    sweep_stats sweep( const sweep_params& ps );
 
     // Get the network
     aig_ntk const& network() const;
 
-    // Solve the loaded circuit
-    std::pair<bool, std::optional<std::vector<bool>>> solve();
+    // Set the parameters used by the following calls to solve
+    void set_params( const aig_dpll_params& ps );
+
+    // Number of solvers racing in solve, 1 runs a single solver with the parameters as set
+    void set_threads( uint32_t num_threads );
+
+    // Solve the loaded circuit, the status is unknown when the conflict limit of the parameters is reached
+    solve_result solve();
+
+    // Incremental solving under assumptions, literals ( node << 1 ) | complement as in get_outputs(), each assumed 1
+    // and the outputs not asserted. One single-threaded solver serves every call until the network or parameters change
+    solve_result solve( const std::vector<uint32_t>& assumptions );
+
+    // Assumptions of the last unsatisfiable incremental solve that are contradictory on their own
+    const std::vector<uint32_t>& failed_assumptions() const;
+
+    // Solve each output separately on its cone of influence, with set_threads workers; one
+    // result per output, see solve_aig_outputs
+    std::vector<solve_result> solve_outputs();
 
   private:
     struct Impl;
@@ -0,0 +1,121 @@
+/**
+ * @file strash_table.hpp
+ * @brief Open addressing hash table of AND gates keyed by their fanin literals
+ * @copyright Copyright (c) 2023- Zhufei Chu, Ningbo University. MIT License.
+ */
+
+#ifndef CIRSAT_STRASH_TABLE_HPP
+#define CIRSAT_STRASH_TABLE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace cirsat {
+
+// Maps an ordered pair of fanin literals to the node of the AND gate computing it. Linear
+// probing over a power of two number of slots, the table doubles when it is half full.
+class strash_table
+{
+  public:
+    static constexpr uint32_t EMPTY = 0xffffffffu;
+
+    // Node of the AND gate with fanins ( left, right ), EMPTY if there is none
+    uint32_t find( uint32_t left, uint32_t right ) const
+    {
+        if ( m_slots.empty() )
+        {
+            return EMPTY;
+        }
+        for ( size_t i = slot_of( left, right );; i = ( i + 1 ) & m_mask )
+        {
+            const entry& e = m_slots[i];
+            if ( e.node == EMPTY )
+            {
+                return EMPTY;
+            }
+            if ( e.left == left && e.right == right )
+            {
+                return e.node;
+            }
+        }
+    }
+
+    // The pair must not be in the table yet
+    void insert( uint32_t left, uint32_t right, uint32_t node )
+    {
+        if ( 2u * ( m_size + 1u ) > m_slots.size() )
+        {
+            grow();
+        }
+        place( { left, right, node } );
+        ++m_size;
+    }
+
+    void reserve( size_t num_gates )
+    {
+        while ( 2u * num_gates > m_slots.size() )
+        {
+            grow();
+        }
+    }
+
+    size_t size() const
+    {
+        return m_size;
+    }
+
+    void clear()
+    {
+        std::vector<entry>().swap( m_slots );
+        m_mask = 0u;
+        m_size = 0u;
+    }
+
+  private:
+    struct entry {
+        uint32_t left;
+        uint32_t right;
+        uint32_t node;
+    };
+
+    size_t slot_of( uint32_t left, uint32_t right ) const
+    {
+        uint64_t key = ( static_cast<uint64_t>( left ) << 32 ) | right;
+        return static_cast<size_t>( ( key * 0x9e3779b97f4a7c15ull ) >> 32 ) & m_mask;
+    }
+
+    void place( const entry& e )
+    {
+        size_t i = slot_of( e.left, e.right );
+        while ( m_slots[i].node != EMPTY )
+        {
+            i = ( i + 1 ) & m_mask;
+        }
+        m_slots[i] = e;
+    }
+
+    void grow()
+    {
+        std::vector<entry> old( m_slots.empty() ? 16u : 2u * m_slots.size(),
+                                entry{ EMPTY, EMPTY, EMPTY } );
+        old.swap( m_slots );
+        m_mask = m_slots.size() - 1u;
+        for ( const entry& e : old )
+        {
+            if ( e.node != EMPTY )
+            {
+                place( e );
+            }
+        }
+    }
+
+  private:
+    std::vector<entry> m_slots;
+    size_t m_mask{ 0u };
+    size_t m_size{ 0u };
+};
+
+} // namespace cirsat
+
+#endif // CIRSAT_STRASH_TABLE_HPP
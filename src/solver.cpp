@@ -7,14 +7,23 @@
 #include "solver.hpp"
 #include "aig.hpp"
 #include "aig_dpll_solver.hpp"
+#include "aiger_mmap_reader.hpp"
 #include "aiger_reader.hpp"
+#include "output_solver.hpp"
+#include "portfolio.hpp"
+#include "sat_sweeper.hpp"
 #include <fstream>
+#include <memory>
 #include <lorina/aiger.hpp>
 
 namespace cirsat {
 
 struct Solver::Impl {
     aig_ntk network;
+    aig_dpll_params params;
+    uint32_t num_threads{ 1u };
+    // solver of the incremental calls, created by the first one; it refers to network
+    std::unique_ptr<aig_dpll_solver> incremental;
 };
 
 Solver::Solver() : pimpl( new Impl() )
@@ -26,29 +35,84 @@ Solver::~Solver()
     delete pimpl;
 }
 
-bool Solver::load_aiger( const std::string& filename )
+bool Solver::load_aiger( const std::string& filename, bool strash )
 {
-    cirsat::aiger_reader<cirsat::aig_ntk> reader( pimpl->network );
-    std::ifstream file( filename );
-    if ( !file.is_open() )
+    pimpl->incremental.reset();
+    pimpl->network = aig_ntk();
+    pimpl->network.set_strash( strash );
+    mapped_file mapped( filename );
+    if ( !mapped.is_open() )
     {
         return false;
     }
+    if ( is_binary_aiger( mapped.data(), mapped.size() ) )
+    {
+        return read_binary_aiger( mapped.data(), mapped.size(), pimpl->network );
+    }
 
-    auto result = lorina::read_aiger( file, reader );
+    // ASCII AIGER goes through lorina
+    cirsat::aiger_reader<cirsat::aig_ntk> reader( pimpl->network );
+    std::ifstream file( filename );
+    auto result = lorina::read_ascii_aiger( file, reader );
     file.close();
 
     return result == lorina::return_code::success;
 }
 
+sweep_stats Solver::sweep( const sweep_params& ps )
+{
+    aig_ntk swept;
+    sweep_stats st = sweep_aig( pimpl->network, swept, ps );
+    pimpl->incremental.reset();
+    pimpl->network = std::move( swept );
+    return st;
+}
+
 aig_ntk const& Solver::network() const
 {
     return pimpl->network;
 }
 
-std::pair<bool, std::optional<std::vector<bool>>> Solver::solve()
+void Solver::set_params( const aig_dpll_params& ps )
+{
+    pimpl->params = ps;
+    pimpl->incremental.reset();
+}
+
+void Solver::set_threads( uint32_t num_threads )
+{
+    pimpl->num_threads = num_threads;
+}
+
+solve_result Solver::solve()
+{
+    return cirsat::solve_aig_portfolio( pimpl->network, pimpl->params, pimpl->num_threads );
+}
+
+solve_result Solver::solve( const std::vector<uint32_t>& assumptions )
+{
+    if ( !pimpl->incremental )
+    {
+        pimpl->incremental.reset( new aig_dpll_solver( pimpl->network, pimpl->params ) );
+    }
+    std::vector<bool> solution;
+    if ( pimpl->incremental->solve( solution, assumptions ) )
+    {
+        return { sat_status::sat, std::move( solution ) };
+    }
+    return { pimpl->incremental->status( false ), std::nullopt };
+}
+
+const std::vector<uint32_t>& Solver::failed_assumptions() const
+{
+    static const std::vector<uint32_t> none;
+    return pimpl->incremental ? pimpl->incremental->failed_assumptions() : none;
+}
+
+std::vector<solve_result> Solver::solve_outputs()
 {
-    return cirsat::solve_aig( pimpl->network );
+    std::vector<output_report> reports;
+    return cirsat::solve_aig_outputs( pimpl->network, pimpl->params, pimpl->num_threads, reports );
 }
 
 } // namespace cirsat
\ No newline at end of file
@@ -0,0 +1,58 @@
+/**
+ * @file aig.cpp
+ * @brief Test of the AIG network construction
+ * @copyright Copyright (c) 2023- Zhufei Chu, Ningbo University. MIT License.
+ */
+
+#include "aig.hpp"
+#include <catch.hpp>
+
+namespace cirsat {
+
+TEST_CASE( "structural hashing in create_and", "[aig]" )
+{
+    aig_ntk network;
+    network.set_strash( true );
+    network.set_num_pis( 2 );
+    network.set_num_gates( 4 );
+    network.create_constant();
+    network.create_pi();
+    network.create_pi();
+
+    gate const0( 0u ), const1( 1u );
+    gate a( 1, 0 ), b( 2, 0 );
+
+    CHECK( network.create_and( a, const0 ) == const0 );
+    CHECK( network.create_and( const1, a ) == a );
+    CHECK( network.create_and( a, a ) == a );
+    CHECK( network.create_and( a, !a ) == const0 );
+    CHECK( network.num_nodes() == 3u );
+
+    gate ab = network.create_and( a, b );
+    CHECK( network.num_nodes() == 4u );
+    CHECK( network.create_and( b, a ) == ab );
+    CHECK( network.create_and_lit( b.data, a.data ) == ab.data );
+    CHECK( network.create_and( !a, b ) != ab );
+    CHECK( network.num_nodes() == 5u );
+    CHECK( network.get_num_refs( 1 ) == 2u );
+}
+
+TEST_CASE( "create_and without structural hashing", "[aig]" )
+{
+    aig_ntk network;
+    network.set_num_pis( 2 );
+    network.create_constant();
+    network.create_pi();
+    network.create_pi();
+
+    gate a( 1, 0 ), b( 2, 0 );
+    gate ab = network.create_and( a, b );
+    CHECK( network.create_and( b, a ) != ab );
+    CHECK( network.num_nodes() == 5u );
+
+    network.build_fanouts();
+    CHECK( network.get_fanouts( 1 ).size() == 2u );
+    CHECK( network.get_fanouts( 3 ).size() == 0u );
+}
+
+} // namespace cirsat
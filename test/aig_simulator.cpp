@@ -0,0 +1,66 @@
+/**
+ * @file aig_simulator.cpp
+ * @brief Test of the bit-parallel random simulation
+ * @copyright Copyright (c) 2023- Zhufei Chu, Ningbo University. MIT License.
+ */
+
+#include "aig_simulator.hpp"
+#include "solver.hpp"
+#include <catch.hpp>
+
+namespace cirsat {
+
+TEST_CASE( "simulation evaluates every pattern", "[aig_simulator]" )
+{
+    // f = a & !b, g = !( f & !a ) which is constant 1
+    aig_ntk network;
+    network.set_num_pis( 2 );
+    network.create_constant();
+    network.create_pi();
+    network.create_pi();
+    gate a( 1, 0 ), b( 2, 0 );
+    gate f = network.create_and( a, !b );
+    gate g = !network.create_and( f, !a );
+    network.create_po( g );
+    network.build_fanouts();
+
+    // 9 words exercise the wide kernels and the scalar tail
+    aig_simulator sim( network, 9u );
+    std::mt19937_64 rng( 1u );
+    sim.randomize_inputs( rng );
+    sim.simulate();
+    for ( uint64_t p = 0; p < sim.num_patterns(); ++p )
+    {
+        bool va = sim.value( a.index, p ), vb = sim.value( b.index, p );
+        REQUIRE( sim.value( f.index, p ) == ( va && !vb ) );
+        REQUIRE( sim.value( g.index, p ) == false );
+    }
+    CHECK( sim.find_satisfying_pattern() == 0 );
+    CHECK( sim.count_ones( f.index ) < sim.num_patterns() );
+
+    // g is 1 under every input, a second output f is only 1 for a = 1, b = 0
+    network.create_po( f );
+    CHECK( check_solution( network, { true, false } ) );
+    CHECK_FALSE( check_solution( network, { true, true } ) );
+    CHECK_FALSE( check_solution( network, { false, false } ) );
+}
+
+TEST_CASE( "random simulation solves easy SAT instances", "[aig_simulator]" )
+{
+    Solver solver;
+    REQUIRE( solver.load_aiger( "../benchmarks/aiger/SAT/max46.aig" ) );
+    std::vector<bool> solution;
+    REQUIRE( simulate_for_solution( solver.network(), 4u, 16u, 0u, solution ) );
+    CHECK( solution.size() == solver.network().get_num_pis() );
+    CHECK( check_solution( solver.network(), solution ) );
+
+    auto [status, model] = solver.solve();
+    REQUIRE( status == sat_status::sat );
+    REQUIRE( model.has_value() );
+    CHECK( check_solution( solver.network(), *model ) );
+
+    REQUIRE( solver.load_aiger( "../benchmarks/aiger/UNSAT/ISCAS85/c432.aiger" ) );
+    CHECK_FALSE( simulate_for_solution( solver.network(), 4u, 16u, 0u, solution ) );
+}
+
+} // namespace cirsat
@@ -5,8 +5,10 @@
  */
 
 #define CATCH_CONFIG_MAIN
+#include "aiger_mmap_reader.hpp"
 #include "aiger_reader.hpp"
 #include "aig.hpp"
+#include "aig_dpll_solver.hpp"
 #include <catch.hpp>
 #include <fstream>
 #include <iostream>
@@ -19,7 +21,7 @@ TEST_CASE( "read and parse local AIGER file", "[aiger_reader]" )
 
     aiger_reader<aig_ntk> reader( network );
 
-    std::string file_path = "../benchmarks/aiger/c6288.aiger";
+    std::string file_path = "../benchmarks/aiger/UNSAT/ISCAS85/c6288.aiger";
 
     std::ifstream file( file_path );
     REQUIRE( file.is_open() );
@@ -37,14 +39,63 @@ TEST_CASE( "read and parse local AIGER file", "[aiger_reader]" )
     CHECK( num_pis == 32 );
     CHECK( network.get_num_pis() == 32 );
 
-    uint32_t num_gates = 0;
-    for ( const auto& gate : network.get_gates() )
-    {
-        num_gates++;
-    }
-    CHECK( num_gates == 4106 );
+    CHECK( network.num_nodes() == 4106 );
+    CHECK( network.has_fanouts() );
     CHECK( network.get_num_gates() == 4073 ); // num_pis + num_pos + num_gates
     CHECK( network.get_num_pos() == 1 );
 }
 
+TEST_CASE( "memory-mapped binary AIGER parser matches lorina", "[aiger_reader]" )
+{
+    std::string file_path = "../benchmarks/aiger/UNSAT/ISCAS85/c7552.aiger";
+
+    aig_ntk expected;
+    aiger_reader<aig_ntk> reader( expected );
+    std::ifstream file( file_path );
+    REQUIRE( file.is_open() );
+    REQUIRE( lorina::read_aiger( file, reader ) == lorina::return_code::success );
+
+    aig_ntk network;
+    REQUIRE( read_binary_aiger( file_path, network ) );
+    CHECK( network.num_nodes() == expected.num_nodes() );
+    CHECK( network.get_outputs() == expected.get_outputs() );
+    CHECK( network.has_fanouts() );
+    for ( GateId id = 0; id < network.num_nodes(); ++id )
+    {
+        CHECK( network.get_children( id ) == expected.get_children( id ) );
+        CHECK( network.get_fanouts( id ).size() == expected.get_fanouts( id ).size() );
+    }
+
+    const char truncated[] = "aig 3 2 0 1 1\n6\n\x02";
+    aig_ntk broken;
+    CHECK_FALSE( read_binary_aiger( truncated, sizeof( truncated ) - 1, broken ) );
+}
+
+TEST_CASE( "binary AIGER gates on one node keep their variable", "[aiger_reader]" )
+{
+    // the output is gate 2, x & x in the first file and x & !x in the second
+    const char same[] = "aig 2 1 0 1 1\n4\n\x02\x00";
+    const char opposite[] = "aig 2 1 0 1 1\n4\n\x01\x01";
+    for ( bool strash : { false, true } )
+    {
+        aig_ntk x_and_x;
+        x_and_x.set_strash( strash );
+        REQUIRE( read_binary_aiger( same, sizeof( same ) - 1, x_and_x ) );
+        CHECK( x_and_x.num_nodes() == ( strash ? 2u : 3u ) );
+        auto [status_same, solution] = solve_aig( x_and_x );
+        REQUIRE( status_same == sat_status::sat );
+        CHECK( *solution == std::vector<bool>{ true } );
+
+        aig_ntk x_and_not_x;
+        x_and_not_x.set_strash( strash );
+        REQUIRE( read_binary_aiger( opposite, sizeof( opposite ) - 1, x_and_not_x ) );
+        CHECK( x_and_not_x.num_nodes() == ( strash ? 2u : 3u ) );
+        CHECK( solve_aig( x_and_not_x ).first == sat_status::unsat );
+    }
+
+    const char constant[] = "aig 1 0 0 1 1\n2\n\x01\x01";
+    aig_ntk broken;
+    CHECK_FALSE( read_binary_aiger( constant, sizeof( constant ) - 1, broken ) );
+}
+
 } // namespace cirsat
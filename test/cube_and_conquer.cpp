@@ -0,0 +1,133 @@
+/**
+ * @file cube_and_conquer.cpp
+ * @brief Test of the lookahead cubes and their parallel solving
+ * @copyright Copyright (c) 2023- Zhufei Chu, Ningbo University. MIT License.
+ */
+
+#include "aig_simulator.hpp"
+#include "cube_and_conquer.hpp"
+#include "solver.hpp"
+#include <algorithm>
+#include <catch.hpp>
+#include <sstream>
+
+namespace cirsat {
+
+TEST_CASE( "cube-and-conquer on an UNSAT miter", "[cube_and_conquer]" )
+{
+    Solver solver;
+    REQUIRE( solver.load_aiger( "../benchmarks/aiger/UNSAT/ISCAS85/c432.aiger" ) );
+    const aig_ntk& network = solver.network();
+
+    aig_dpll_params ps;
+    cube_params cps;
+    cps.num_cubes = 64u;
+    std::vector<std::vector<uint32_t>> cubes;
+    std::vector<bool> solution;
+    REQUIRE_FALSE( generate_cubes( network, ps, cps, cubes, solution ) );
+    CHECK( !cubes.empty() );
+    CHECK( cubes.size() <= 64u );
+
+    // the cubes survive a round trip through the text format
+    std::stringstream text;
+    write_cubes( text, cubes );
+    std::vector<std::vector<uint32_t>> read;
+    REQUIRE( read_cubes( text, network, read ) );
+    CHECK( read == cubes );
+
+    std::vector<cube_report> reports;
+    auto [status, model] = solve_cubes( network, ps, cubes, 3u, reports );
+    CHECK( status == sat_status::unsat );
+    REQUIRE( reports.size() == cubes.size() );
+    for ( const auto& report : reports )
+    {
+        CHECK( report.status == sat_status::unsat );
+    }
+}
+
+TEST_CASE( "cube-and-conquer finds a satisfying assignment", "[cube_and_conquer]" )
+{
+    Solver solver;
+    REQUIRE( solver.load_aiger( "../benchmarks/aiger/SAT/9sym.aig" ) );
+
+    cube_params cps;
+    cps.num_cubes = 16u;
+    cps.num_threads = 2u;
+    std::vector<cube_report> reports;
+    // without simulation the model comes from the lookahead or a cube solver
+    aig_dpll_params ps;
+    ps.sat_simulation_rounds = 0u;
+    auto [status, model] = solve_aig_cube_and_conquer( solver.network(), ps, cps, reports );
+    CHECK( status == sat_status::sat );
+    REQUIRE( model.has_value() );
+    CHECK( check_solution( solver.network(), *model ) );
+
+    // deeper, the lookahead itself may meet a solution, otherwise the cubes are solved apart
+    std::vector<std::vector<uint32_t>> cubes;
+    std::vector<bool> solution;
+    cps.num_cubes = 64u;
+    if ( !generate_cubes( solver.network(), ps, cps, cubes, solution ) )
+    {
+        auto [cube_status, cube_model] = solve_cubes( solver.network(), ps, cubes, 2u, reports );
+        CHECK( cube_status == sat_status::sat );
+        REQUIRE( cube_model.has_value() );
+        solution = *cube_model;
+    }
+    CHECK( check_solution( solver.network(), solution ) );
+}
+
+TEST_CASE( "cube literals are assumption literals", "[cube_and_conquer]" )
+{
+    Solver solver;
+    REQUIRE( solver.load_aiger( "../benchmarks/aiger/SAT/9sym.aig" ) );
+    const aig_ntk& network = solver.network();
+
+    std::stringstream text( "a 5 -7 0\n" );
+    std::vector<std::vector<uint32_t>> read;
+    REQUIRE( read_cubes( text, network, read ) );
+    CHECK( read == std::vector<std::vector<uint32_t>>{ { 10u, 15u } } );
+
+    // whether every literal of the cube is 1 under the input values of model
+    auto holds = [&]( const std::vector<uint32_t>& cube, const std::vector<bool>& model ) {
+        aig_simulator sim( network, 1u );
+        for ( size_t i = 0; i < model.size(); ++i )
+        {
+            sim.signature( network.get_inputs()[i] )[0] = model[i] ? 1u : 0u;
+        }
+        sim.simulate();
+        return std::all_of( cube.begin(), cube.end(), [&]( uint32_t lit ) {
+            return sim.value( aig_ntk::data_to_index( lit ), 0u ) != aig_ntk::data_to_complement( lit );
+        } );
+    };
+
+    aig_dpll_params ps;
+    ps.sat_simulation_rounds = 0u;
+    cube_params cps;
+    cps.num_cubes = 8u;
+    std::vector<std::vector<uint32_t>> cubes;
+    std::vector<bool> solution;
+    REQUIRE_FALSE( generate_cubes( network, ps, cps, cubes, solution ) );
+    REQUIRE( !cubes.empty() );
+    for ( const auto& cube : cubes )
+    {
+        std::vector<cube_report> reports;
+        auto [cube_status, cube_model] = solve_cubes( network, ps, { cube }, 1u, reports );
+        if ( cube_status == sat_status::sat )
+        {
+            CHECK( holds( cube, *cube_model ) );
+        }
+
+        // the same literals as assumptions, with the outputs that the cube solvers assert
+        std::vector<uint32_t> assumptions = cube;
+        assumptions.insert( assumptions.end(), network.get_outputs().begin(), network.get_outputs().end() );
+        auto [status, model] = solver.solve( assumptions );
+        CHECK( status == cube_status );
+        if ( status == sat_status::sat )
+        {
+            CHECK( holds( cube, *model ) );
+            CHECK( check_solution( network, *model ) );
+        }
+    }
+}
+
+} // namespace cirsat
@@ -0,0 +1,45 @@
+/**
+ * @file learned_exchange.cpp
+ * @brief Test of the ring buffer sharing learned gates between solvers
+ * @copyright Copyright (c) 2023- Zhufei Chu, Ningbo University. MIT License.
+ */
+
+#include "learned_exchange.hpp"
+#include <catch.hpp>
+#include <vector>
+
+namespace cirsat {
+
+TEST_CASE( "learned gates are delivered to the other solvers", "[learned_exchange]" )
+{
+    learned_exchange exchange( 4u );
+    const uint32_t gate[] = { 4u, 7u, 10u };
+    CHECK( exchange.publish( 0u, gate, 3u, 2u ) );
+    CHECK_FALSE( exchange.publish( 0u, gate, 0u, 0u ) );
+
+    std::vector<uint32_t> received;
+    uint64_t cursor = 0u;
+    exchange.collect( 1u, cursor, [&]( const uint32_t* lits, uint32_t size, uint32_t lbd ) {
+        received.assign( lits, lits + size );
+        CHECK( lbd == 2u );
+    } );
+    CHECK( received == std::vector<uint32_t>{ 4u, 7u, 10u } );
+    CHECK( cursor == exchange.tail() );
+
+    // the publisher does not read its own gates back
+    uint64_t own_cursor = 0u;
+    uint32_t count = 0u;
+    exchange.collect( 0u, own_cursor, [&]( const uint32_t*, uint32_t, uint32_t ) { ++count; } );
+    CHECK( count == 0u );
+
+    // a reader more than one ring behind only sees the last ring
+    for ( uint32_t i = 0; i < 10u; ++i )
+    {
+        exchange.publish( 2u, &i, 1u, 1u );
+    }
+    std::vector<uint32_t> units;
+    exchange.collect( 1u, cursor, [&]( const uint32_t* lits, uint32_t, uint32_t ) { units.push_back( lits[0] ); } );
+    CHECK( units == std::vector<uint32_t>{ 6u, 7u, 8u, 9u } );
+}
+
+} // namespace cirsat
@@ -0,0 +1,64 @@
+/**
+ * @file output_solver.cpp
+ * @brief Test of per-output solving on cones of influence
+ * @copyright Copyright (c) 2023- Zhufei Chu, Ningbo University. MIT License.
+ */
+
+#include "output_solver.hpp"
+#include <catch.hpp>
+
+namespace cirsat {
+
+TEST_CASE( "each output is solved on its own cone", "[output_solver]" )
+{
+    // o0 = a & !a folds to 0, o1 = b & c, o2 = ( b & c ) & !b, o3 = !0
+    aig_ntk network;
+    network.set_strash( true );
+    network.set_num_pis( 4 );
+    network.create_constant();
+    for ( int i = 0; i < 4; ++i )
+    {
+        network.create_pi();
+    }
+    gate a( 1, 0 ), b( 2, 0 ), c( 3, 0 );
+    gate bc = network.create_and( b, c );
+    network.create_po( network.create_and( a, !a ) );
+    network.create_po( bc );
+    network.create_po( network.create_and( bc, !b ) );
+    network.create_po( !network.create_and( a, !a ) );
+    network.build_fanouts();
+
+    // without simulation every output goes through the solver on its cone
+    aig_dpll_params ps;
+    ps.sat_simulation_rounds = 0u;
+    for ( uint32_t threads : { 1u, 3u } )
+    {
+        std::vector<output_report> reports;
+        auto results = solve_aig_outputs( network, ps, threads, reports );
+        REQUIRE( results.size() == 4u );
+        REQUIRE( reports.size() == 4u );
+        CHECK( results[0].first == sat_status::unsat );
+        CHECK( results[2].first == sat_status::unsat );
+        CHECK( results[3].first == sat_status::sat );
+
+        REQUIRE( results[1].first == sat_status::sat );
+        REQUIRE( results[1].second );
+        const auto& solution = *results[1].second;
+        REQUIRE( solution.size() == 4u );
+        CHECK( solution[1] );
+        CHECK( solution[2] );
+        CHECK( reports[1].cone_inputs == 2u );
+        CHECK( reports[1].cone_nodes == 4u );
+    }
+
+    // the simulation fast path answers the satisfiable outputs without a cone
+    std::vector<output_report> reports;
+    auto results = solve_aig_outputs( network, aig_dpll_params(), 2u, reports );
+    REQUIRE( results[1].first == sat_status::sat );
+    CHECK( ( *results[1].second )[1] );
+    CHECK( ( *results[1].second )[2] );
+    CHECK( reports[1].cone_nodes == 0u );
+    CHECK( results[2].first == sat_status::unsat );
+}
+
+} // namespace cirsat
@@ -0,0 +1,125 @@
+/**
+ * @file sat_sweeper.cpp
+ * @brief Test of cone extraction and SAT sweeping
+ * @copyright Copyright (c) 2023- Zhufei Chu, Ningbo University. MIT License.
+ */
+
+#include "aig_cone.hpp"
+#include "sat_sweeper.hpp"
+#include "solver.hpp"
+#include <catch.hpp>
+
+namespace cirsat {
+
+TEST_CASE( "cone extraction renumbers the cone densely", "[sat_sweeper]" )
+{
+    // f = a & b, g = c & !f, h = a & c, the cone of g leaves h out
+    aig_ntk network;
+    network.set_num_pis( 3 );
+    network.create_constant();
+    network.create_pi();
+    network.create_pi();
+    network.create_pi();
+    gate a( 1, 0 ), b( 2, 0 ), c( 3, 0 );
+    gate f = network.create_and( a, b );
+    gate g = network.create_and( c, !f );
+    gate h = network.create_and( a, c );
+    network.create_po( g );
+    network.create_po( h );
+    network.build_fanouts();
+
+    aig_ntk cone;
+    std::vector<GateId> inputs;
+    auto roots = extract_cone( network, { ( uint32_t( g.index ) << 1 ) | 1u }, cone, false, &inputs );
+    cone.create_po_lit( roots[0] );
+    cone.build_fanouts();
+    CHECK( cone.num_nodes() == 6u );
+    CHECK( inputs == std::vector<GateId>{ 1u, 2u, 3u } );
+    CHECK( roots[0] == ( ( 5u << 1 ) | 1u ) );
+    CHECK( cone.get_children( 5u )[0] == ( 3u << 1 ) );
+    CHECK( cone.get_children( 5u )[1] == ( ( 4u << 1 ) | 1u ) );
+
+    aig_ntk small;
+    roots = extract_cone( network, { uint32_t( h.index ) << 1 }, small, false, &inputs );
+    CHECK( small.num_nodes() == 4u );
+    CHECK( inputs == std::vector<GateId>{ 1u, 3u } );
+    CHECK( roots[0] == ( 3u << 1 ) );
+}
+
+TEST_CASE( "sweeping merges equivalent nodes", "[sat_sweeper]" )
+{
+    // the miter of two copies of f = a & ( b | c ) written differently
+    aig_ntk network;
+    network.set_num_pis( 3 );
+    network.create_constant();
+    network.create_pi();
+    network.create_pi();
+    network.create_pi();
+    gate a( 1, 0 ), b( 2, 0 ), c( 3, 0 );
+    gate f1 = network.create_and( a, !network.create_and( !b, !c ) );
+    gate f2 = !network.create_and( !network.create_and( a, b ), !network.create_and( a, c ) );
+    gate only1 = network.create_and( f1, !f2 );
+    gate only2 = network.create_and( !f1, f2 );
+    network.create_po( !network.create_and( !only1, !only2 ) );
+    network.build_fanouts();
+
+    aig_ntk swept;
+    sweep_stats st = sweep_aig( network, swept );
+    CHECK( st.proved > 0u );
+    CHECK( swept.num_nodes() == 4u );
+    REQUIRE( swept.get_outputs().size() == 1u );
+    CHECK( swept.get_outputs()[0] == 0u );
+}
+
+TEST_CASE( "counterexamples are resimulated in batches", "[sat_sweeper]" )
+{
+    Solver solver;
+    REQUIRE( solver.load_aiger( "../benchmarks/aiger/UNSAT/ISCAS85/c1908.aiger" ) );
+    sweep_stats st = solver.sweep( sweep_params() );
+    REQUIRE( st.refuted > 1u );
+    CHECK( st.refinements <= st.refuted / 64u );
+    CHECK( solver.solve().first == sat_status::unsat );
+}
+
+TEST_CASE( "sweeping preserves satisfiability", "[sat_sweeper]" )
+{
+    Solver solver;
+    REQUIRE( solver.load_aiger( "../benchmarks/aiger/UNSAT/ISCAS85/c432.aiger" ) );
+    uint32_t before = solver.network().num_nodes();
+    sweep_stats st = solver.sweep( sweep_params() );
+    CHECK( st.nodes_before == before );
+    CHECK( solver.network().num_nodes() < before );
+    CHECK( solver.solve().first == sat_status::unsat );
+
+    Solver original;
+    REQUIRE( solver.load_aiger( "../benchmarks/aiger/SAT/max46.aig" ) );
+    REQUIRE( original.load_aiger( "../benchmarks/aiger/SAT/max46.aig" ) );
+    solver.sweep( sweep_params() );
+    REQUIRE( solver.network().get_num_pis() == original.network().get_num_pis() );
+    auto [status, solution] = solver.solve();
+    REQUIRE( status == sat_status::sat );
+    REQUIRE( solution );
+
+    // the solution of the swept network satisfies the original one
+    const aig_ntk& ntk = original.network();
+    std::vector<bool> values( ntk.num_nodes(), false );
+    const auto& inputs = ntk.get_inputs();
+    for ( size_t i = 0; i < inputs.size(); ++i )
+    {
+        values[inputs[i]] = ( *solution )[i];
+    }
+    auto value = [&]( uint32_t lit ) { return values[aig_ntk::data_to_index( lit )] != aig_ntk::data_to_complement( lit ); };
+    for ( GateId id = 1; id < ntk.num_nodes(); ++id )
+    {
+        if ( ntk.is_and( id ) )
+        {
+            values[id] = value( ntk.get_children( id )[0] ) && value( ntk.get_children( id )[1] );
+        }
+    }
+    for ( uint32_t out : ntk.get_outputs() )
+    {
+        CHECK( value( out ) );
+    }
+}
+
+} // namespace cirsat
@@ -2,10 +2,85 @@
 #include "catch2/catch.hpp"
 #include "solver.hpp"
 
+#include "aig.hpp"
+#include "aig_dpll_solver.hpp"
+#include "aig_simulator.hpp"
 #include "catch2/catch.hpp"
 #include "solver.hpp"
+#include <algorithm>
 #include <cstdio>
 #include <fstream>
+#include <string>
+
+namespace {
+
+// Small benchmarks that still need a few hundred conflicts with some configurations
+const std::pair<const char*, cirsat::sat_status> small_benchmarks[] = {
+    { "../benchmarks/aiger/SAT/9symml.aig", cirsat::sat_status::sat },
+    { "../benchmarks/aiger/SAT/Z9sym.aig", cirsat::sat_status::sat },
+    { "../benchmarks/aiger/SAT/max46.aig", cirsat::sat_status::sat },
+    { "../benchmarks/aiger/UNSAT/ISCAS85/c17_miter.aiger", cirsat::sat_status::unsat },
+    { "../benchmarks/aiger/UNSAT/alu3.aig", cirsat::sat_status::unsat },
+    { "../benchmarks/aiger/UNSAT/mp2d.aig", cirsat::sat_status::unsat },
+    { "../benchmarks/aiger/UNSAT/in4.aig", cirsat::sat_status::unsat },
+};
+
+// Solve the small benchmarks with ps and with the default parameters, the answers must agree and
+// every SAT model must set the outputs to 1. Simulation is off so that the search finds the models.
+void check_against_default( cirsat::aig_dpll_params ps )
+{
+    ps.sat_simulation_rounds = 0u;
+    cirsat::aig_dpll_params reference;
+    reference.sat_simulation_rounds = 0u;
+    for ( const auto& [file, expected] : small_benchmarks )
+    {
+        INFO( file );
+        cirsat::Solver solver;
+        REQUIRE( solver.load_aiger( file ) );
+        CHECK( cirsat::solve_aig( solver.network(), reference ).first == expected );
+        auto [status, solution] = cirsat::solve_aig( solver.network(), ps );
+        CHECK( status == expected );
+        if ( status == cirsat::sat_status::sat )
+        {
+            REQUIRE( solution.has_value() );
+            CHECK( cirsat::check_solution( solver.network(), *solution ) );
+        }
+    }
+}
+
+// Whether every live learned gate of db is satisfied by the network values under the input
+// values of solution, learned gates must hold in every model of the outputs
+bool learned_gates_hold( const cirsat::aig_ntk& ntk, const cirsat::learned_db& db, const std::vector<bool>& solution )
+{
+    const auto& inputs = ntk.get_inputs();
+    cirsat::aig_simulator sim( ntk, 1u );
+    for ( size_t i = 0; i < inputs.size(); ++i )
+    {
+        sim.signature( inputs[i] )[0] = solution[i] ? 1u : 0u;
+    }
+    sim.simulate();
+    for ( cirsat::LearnedRef ref = 0; ref < db.capacity(); ++ref )
+    {
+        if ( db.info( ref ).removed )
+        {
+            continue;
+        }
+        const uint32_t* lits = db.lits( ref );
+        bool satisfied = false;
+        for ( uint32_t l = 0; l < db.size( ref ) && !satisfied; ++l )
+        {
+            satisfied = sim.value( cirsat::learned_db::lit_node( lits[l] ), 0u ) !=
+                        cirsat::learned_db::lit_watch_value( lits[l] );
+        }
+        if ( !satisfied )
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
 
 TEST_CASE( "Solver Basic Tests", "[solver]" )
 {
@@ -23,8 +98,8 @@ TEST_CASE( "Solver Basic Tests", "[solver]" )
         bool loaded = solver.load_aiger( "temp_sat.aag" );
         REQUIRE( loaded == true );
 
-        auto [is_sat, solution] = solver.solve();
-        REQUIRE( is_sat == true );
+        auto [status, solution] = solver.solve();
+        REQUIRE( status == cirsat::sat_status::sat );
         REQUIRE( solution.has_value() );
         REQUIRE( solution->size() == 1 );
         REQUIRE( ( *solution )[0] == true ); // Input must be 1 for output to be 1
@@ -42,9 +117,355 @@ TEST_CASE( "Solver Basic Tests", "[solver]" )
         bool loaded = solver.load_aiger( "temp_unsat.aag" );
         REQUIRE( loaded == true );
 
-        auto [is_sat, solution] = solver.solve();
-        REQUIRE( is_sat == false );
+        auto [status, solution] = solver.solve();
+        REQUIRE( status == cirsat::sat_status::unsat );
 
         std::remove( "temp_unsat.aag" );
     }
-}
\ No newline at end of file
+}
+TEST_CASE( "Loading keeps the AIGER numbering unless strash is asked for", "[solver]" )
+{
+    // gates 3 and 4 are the same AND of a and b, the output is gate 4
+    std::ofstream temp( "temp_strash.aag" );
+    temp << "aag 4 2 0 1 2\n2\n4\n8\n6 2 4\n8 4 2\n";
+    temp.close();
+
+    cirsat::Solver solver;
+    REQUIRE( solver.load_aiger( "temp_strash.aag" ) );
+    CHECK( solver.network().num_nodes() == 5u );
+    CHECK( solver.network().get_outputs() == std::vector<uint32_t>{ 8u } );
+
+    REQUIRE( solver.load_aiger( "temp_strash.aag", true ) );
+    std::remove( "temp_strash.aag" );
+    CHECK( solver.network().num_nodes() == 4u );
+    CHECK( solver.network().get_outputs() == std::vector<uint32_t>{ 6u } );
+}
+
+TEST_CASE( "Networks built in code without set_num_pis or fanouts", "[solver]" )
+{
+    // f = a & b, g = f & !c, output g
+    cirsat::aig_ntk network;
+    network.create_constant();
+    network.create_pi();
+    network.create_pi();
+    network.create_pi();
+    cirsat::gate a( 1, 0 ), b( 2, 0 ), c( 3, 0 );
+    cirsat::gate f = network.create_and( a, b );
+    network.create_po( network.create_and( f, !c ) );
+    REQUIRE_FALSE( network.has_fanouts() );
+
+    auto [status, solution] = cirsat::solve_aig( network );
+    REQUIRE( status == cirsat::sat_status::sat );
+    REQUIRE( solution.has_value() );
+    CHECK( *solution == std::vector<bool>{ true, true, false } );
+
+    network.create_po( network.create_and( f, c ) );
+    CHECK( cirsat::solve_aig( network ).first == cirsat::sat_status::unsat );
+}
+
+TEST_CASE( "Portfolio agrees with a single solver", "[solver]" )
+{
+    cirsat::Solver solver;
+    solver.set_threads( 4 );
+
+    SECTION( "UNSAT miter" )
+    {
+        REQUIRE( solver.load_aiger( "../benchmarks/aiger/UNSAT/ISCAS85/c432.aiger" ) );
+        auto [status, solution] = solver.solve();
+        REQUIRE( status == cirsat::sat_status::unsat );
+    }
+
+    SECTION( "SAT circuit" )
+    {
+        REQUIRE( solver.load_aiger( "../benchmarks/aiger/SAT/9sym.aig" ) );
+        auto [status, solution] = solver.solve();
+        REQUIRE( status == cirsat::sat_status::sat );
+        REQUIRE( solution.has_value() );
+        REQUIRE( solution->size() == 9 );
+    }
+}
+
+TEST_CASE( "Incremental solving under assumptions", "[solver]" )
+{
+    // f = a & b, the output is !f
+    std::ofstream temp( "temp_inc.aag" );
+    temp << "aag 3 2 0 1 1\n2\n4\n7\n6 2 4\n";
+    temp.close();
+
+    cirsat::Solver solver;
+    REQUIRE( solver.load_aiger( "temp_inc.aag" ) );
+    std::remove( "temp_inc.aag" );
+    // literals assumed to be 1: a, b, f and !f
+    const uint32_t a1 = 1u << 1, b1 = 2u << 1, f1 = 3u << 1, f0 = ( 3u << 1 ) | 1u;
+
+    auto [status_f, solution_f] = solver.solve( { f1 } );
+    REQUIRE( status_f == cirsat::sat_status::sat );
+    REQUIRE( solution_f.has_value() );
+    CHECK( ( *solution_f )[0] );
+    CHECK( ( *solution_f )[1] );
+
+    // the output is not asserted, only the assumptions are
+    auto [status_none, solution_none] = solver.solve( {} );
+    CHECK( status_none == cirsat::sat_status::sat );
+
+    auto [status_conflict, solution_conflict] = solver.solve( { a1, f0, b1 } );
+    CHECK( status_conflict == cirsat::sat_status::unsat );
+    auto failed = solver.failed_assumptions();
+    std::sort( failed.begin(), failed.end() );
+    CHECK( failed == std::vector<uint32_t>{ a1, b1, f0 } );
+
+    auto [status_again, solution_again] = solver.solve( { a1, f0 } );
+    REQUIRE( status_again == cirsat::sat_status::sat );
+    CHECK( ( *solution_again )[0] );
+    CHECK_FALSE( ( *solution_again )[1] );
+    CHECK( solver.failed_assumptions().empty() );
+
+    // the miter output of c432 is refuted, and remains so on the next call
+    REQUIRE( solver.load_aiger( "../benchmarks/aiger/UNSAT/ISCAS85/c432.aiger" ) );
+    uint32_t assumption = solver.network().get_outputs()[0];
+    for ( int call = 0; call < 2; ++call )
+    {
+        auto [status, solution] = solver.solve( { assumption } );
+        CHECK( status == cirsat::sat_status::unsat );
+        CHECK( solver.failed_assumptions() == std::vector<uint32_t>{ assumption } );
+    }
+}
+
+TEST_CASE( "Repeated assumptions open more levels than there are nodes", "[solver]" )
+{
+    for ( const char* file : { "../benchmarks/aiger/UNSAT/in4.aig", "../benchmarks/aiger/UNSAT/alu3.aig" } )
+    {
+        INFO( file );
+        cirsat::Solver solver;
+        REQUIRE( solver.load_aiger( file ) );
+        const auto& ntk = solver.network();
+        // each copy of the input literal is a decision level of its own, then the output is refuted
+        std::vector<uint32_t> assumptions( 5u * ntk.num_nodes(), ntk.get_inputs()[0] << 1 );
+        assumptions.push_back( ntk.get_outputs()[0] );
+        CHECK( solver.solve( assumptions ).first == cirsat::sat_status::unsat );
+        CHECK( solver.solve( assumptions ).first == cirsat::sat_status::unsat );
+    }
+}
+
+TEST_CASE( "A conflict limit answers unknown, not UNSAT", "[solver]" )
+{
+    cirsat::Solver solver;
+    REQUIRE( solver.load_aiger( "../benchmarks/aiger/UNSAT/ISCAS85/c432.aiger" ) );
+    cirsat::aig_dpll_params ps;
+    ps.conflict_limit = 1u;
+    solver.set_params( ps );
+
+    CHECK( solver.solve().first == cirsat::sat_status::unknown );
+    CHECK( solver.solve( { solver.network().get_outputs()[0] } ).first == cirsat::sat_status::unknown );
+    CHECK( solver.failed_assumptions().empty() );
+    auto outputs = solver.solve_outputs();
+    REQUIRE( outputs.size() == 1u );
+    CHECK( outputs[0].first == cirsat::sat_status::unknown );
+    solver.set_threads( 3 );
+    CHECK( solver.solve().first == cirsat::sat_status::unknown );
+
+    solver.set_params( cirsat::aig_dpll_params() );
+    CHECK( solver.solve().first == cirsat::sat_status::unsat );
+}
+
+TEST_CASE( "BCP handles implication chains deeper than the call stack", "[solver]" )
+{
+    // c_1 = x_0 & x_1, c_i = c_{i-1} & x_i, output c_n. The inputs are outputs too, asserted in
+    // reverse order, so the last one implies all n AND gates in a single BCP call, deep enough to
+    // overflow a recursive propagation.
+    const uint32_t depth = 200000u;
+    cirsat::aig_ntk ntk;
+    ntk.set_num_pis( depth + 1 );
+    ntk.set_num_pos( depth + 2 );
+    ntk.set_num_gates( depth );
+    ntk.create_constant();
+    for ( uint32_t i = 0; i <= depth; ++i )
+    {
+        ntk.create_pi();
+    }
+    cirsat::gate chain( 1, 0 );
+    for ( uint32_t i = 1; i <= depth; ++i )
+    {
+        chain = ntk.create_and( chain, cirsat::gate( i + 1, 0 ) );
+    }
+    for ( uint32_t i = depth + 1; i >= 1; --i )
+    {
+        ntk.create_po( cirsat::gate( i, 0 ) );
+    }
+    ntk.create_po( chain );
+    ntk.build_fanouts();
+
+    cirsat::aig_dpll_params ps;
+    ps.sat_simulation_rounds = 0u;
+    auto [status, solution] = cirsat::solve_aig( ntk, ps );
+    REQUIRE( status == cirsat::sat_status::sat );
+    REQUIRE( solution.has_value() );
+    CHECK( std::all_of( solution->begin(), solution->end(), []( bool v ) { return v; } ) );
+}
+
+TEST_CASE( "Reduce policies agree with the default configuration", "[solver]" )
+{
+    for ( auto policy : { cirsat::reduce_policy::none, cirsat::reduce_policy::activity, cirsat::reduce_policy::keep_glue,
+                          cirsat::reduce_policy::tiered } )
+    {
+        cirsat::aig_dpll_params ps;
+        ps.reduce = policy;
+        // reduce often enough for the small benchmarks to get there
+        ps.reduce_first = 20u;
+        ps.reduce_inc = 10u;
+        check_against_default( ps );
+    }
+}
+
+TEST_CASE( "Reduction shrinks the learned database", "[solver]" )
+{
+    cirsat::Solver loader;
+    REQUIRE( loader.load_aiger( "../benchmarks/aiger/UNSAT/in4.aig" ) );
+    for ( auto policy : { cirsat::reduce_policy::activity, cirsat::reduce_policy::keep_glue, cirsat::reduce_policy::tiered } )
+    {
+        cirsat::aig_dpll_params ps;
+        ps.decision = cirsat::decision_strategy::vsids;
+        ps.reduce = policy;
+        ps.reduce_first = 50u;
+        ps.reduce_inc = 10u;
+        cirsat::aig_dpll_solver solver( loader.network(), ps );
+        std::vector<bool> solution;
+        CHECK_FALSE( solver.solve( solution ) );
+        CHECK( solver.stats().reductions > 0u );
+        CHECK( solver.stats().removed > 0u );
+        CHECK( solver.learned().num_constraints() < solver.stats().learned );
+    }
+
+    cirsat::aig_dpll_params ps;
+    ps.decision = cirsat::decision_strategy::vsids;
+    ps.reduce = cirsat::reduce_policy::none;
+    cirsat::aig_dpll_solver solver( loader.network(), ps );
+    std::vector<bool> solution;
+    CHECK_FALSE( solver.solve( solution ) );
+    CHECK( solver.stats().removed == 0u );
+    CHECK( solver.learned().num_constraints() == solver.stats().learned );
+}
+
+TEST_CASE( "Decision strategies agree with the default configuration", "[solver]" )
+{
+    for ( auto decision : { cirsat::decision_strategy::jfrontier_fanout, cirsat::decision_strategy::vsids } )
+    {
+        cirsat::aig_dpll_params ps;
+        ps.decision = decision;
+        check_against_default( ps );
+    }
+
+    // vsids with a strong decay
+    cirsat::aig_dpll_params ps;
+    ps.decision = cirsat::decision_strategy::vsids;
+    ps.var_decay = 0.5;
+    check_against_default( ps );
+}
+
+TEST_CASE( "Restart policies agree with the default configuration", "[solver]" )
+{
+    std::vector<uint64_t> sequence;
+    for ( uint64_t i = 1; i <= 15u; ++i )
+    {
+        sequence.push_back( cirsat::luby( i ) );
+    }
+    CHECK( sequence == std::vector<uint64_t>{ 1, 1, 2, 1, 1, 2, 4, 1, 1, 2, 1, 1, 2, 4, 8 } );
+
+    cirsat::Solver loader;
+    REQUIRE( loader.load_aiger( "../benchmarks/aiger/UNSAT/in4.aig" ) );
+    for ( auto restart : { cirsat::restart_policy::none, cirsat::restart_policy::luby, cirsat::restart_policy::geometric,
+                           cirsat::restart_policy::glucose } )
+    {
+        cirsat::aig_dpll_params ps;
+        ps.restart = restart;
+        // restart often, glucose as soon as the recent LBDs are above the average
+        ps.restart_base = 10u;
+        ps.restart_min_conflicts = 10u;
+        ps.restart_margin = 1.0;
+        check_against_default( ps );
+
+        ps.decision = cirsat::decision_strategy::vsids;
+        cirsat::aig_dpll_solver solver( loader.network(), ps );
+        std::vector<bool> solution;
+        CHECK_FALSE( solver.solve( solution ) );
+        CHECK( ( solver.stats().restarts > 0u ) == ( restart != cirsat::restart_policy::none ) );
+    }
+}
+
+TEST_CASE( "Phase policies agree with the default configuration", "[solver]" )
+{
+    cirsat::Solver loader;
+    REQUIRE( loader.load_aiger( "../benchmarks/aiger/UNSAT/in4.aig" ) );
+    for ( auto phase : { cirsat::phase_policy::fixed, cirsat::phase_policy::saved, cirsat::phase_policy::target } )
+    {
+        for ( bool simulation_phase : { false, true } )
+        {
+            cirsat::aig_dpll_params ps;
+            ps.phase = phase;
+            ps.simulation_phase = simulation_phase;
+            ps.rephase_interval = 20u;
+            check_against_default( ps );
+        }
+    }
+
+    cirsat::aig_dpll_params ps;
+    ps.decision = cirsat::decision_strategy::vsids;
+    ps.phase = cirsat::phase_policy::target;
+    ps.rephase_interval = 20u;
+    cirsat::aig_dpll_solver solver( loader.network(), ps );
+    std::vector<bool> solution;
+    CHECK_FALSE( solver.solve( solution ) );
+    CHECK( solver.stats().rephases > 0u );
+}
+
+TEST_CASE( "Learned gates hold in the models found by the search", "[solver]" )
+{
+    cirsat::aig_dpll_params ps;
+    ps.decision = cirsat::decision_strategy::vsids;
+    ps.minimize = false;
+    ps.sat_simulation_rounds = 0u;
+    check_against_default( ps );
+
+    for ( const char* file : { "../benchmarks/aiger/SAT/Z9sym.aig", "../benchmarks/aiger/SAT/9symml.aig" } )
+    {
+        INFO( file );
+        cirsat::Solver loader;
+        REQUIRE( loader.load_aiger( file ) );
+        cirsat::aig_dpll_solver solver( loader.network(), ps );
+        std::vector<bool> solution;
+        REQUIRE( solver.solve( solution ) );
+        CHECK( cirsat::check_solution( loader.network(), solution ) );
+        CHECK( solver.stats().conflicts > 0u );
+        CHECK( solver.learned().num_constraints() > 0u );
+        CHECK( learned_gates_hold( loader.network(), solver.learned(), solution ) );
+    }
+}
+
+TEST_CASE( "Learned gate minimization agrees with the default configuration", "[solver]" )
+{
+    for ( bool minimize : { false, true } )
+    {
+        cirsat::aig_dpll_params ps;
+        ps.minimize = minimize;
+        check_against_default( ps );
+    }
+
+    cirsat::aig_dpll_params ps;
+    ps.decision = cirsat::decision_strategy::vsids;
+    ps.sat_simulation_rounds = 0u;
+
+    cirsat::Solver unsat;
+    REQUIRE( unsat.load_aiger( "../benchmarks/aiger/UNSAT/in4.aig" ) );
+    cirsat::aig_dpll_solver refuter( unsat.network(), ps );
+    std::vector<bool> solution;
+    CHECK_FALSE( refuter.solve( solution ) );
+    CHECK( refuter.stats().minimized > 0u );
+
+    // minimized learned gates must still hold in the model
+    cirsat::Solver sat;
+    REQUIRE( sat.load_aiger( "../benchmarks/aiger/SAT/Z9sym.aig" ) );
+    cirsat::aig_dpll_solver solver( sat.network(), ps );
+    REQUIRE( solver.solve( solution ) );
+    CHECK( cirsat::check_solution( sat.network(), solution ) );
+    CHECK( learned_gates_hold( sat.network(), solver.learned(), solution ) );
+}